@@ -0,0 +1,344 @@
+// Microbenchmarks for the evaluator, abstraction and CFR hot paths.
+//
+//   PokerBotBench [--json <file>] [--baseline <file>] [--threshold <pct>]
+//
+// Every corpus is generated from fixed seeds, so numbers are comparable
+// between commits. --json writes one JSON object per benchmark; passing a
+// previous file as --baseline prints the change and exits non-zero when a
+// benchmark got slower than --threshold percent.
+
+#include "../include/deck.h"
+#include "../include/equity.h"
+#include "../include/game_state.h"
+#include "../include/mccfr/trainer.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// --- Allocation counting ---
+
+static uint64_t g_allocs = 0;
+
+// Out of line so the compiler never pairs the inlined malloc/free itself
+__attribute__((noinline)) void *operator new(std::size_t n) {
+  ++g_allocs;
+  if (void *p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+  std::free(p);
+}
+__attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+// --- Harness ---
+
+struct BenchResult {
+  std::string name;
+  double ns_per_op;
+  double allocs_per_op;
+};
+
+static volatile int64_t g_sink = 0;
+
+// Runs `op(i)` for i in [0, ops) several times; keeps the fastest repetition
+template <class F> BenchResult run_bench(const std::string &name, int ops, F &&op) {
+  const int reps = 5;
+  double best_ns = 1e300;
+  uint64_t allocs = 0;
+
+  int64_t acc = 0;
+  for (int i = 0; i < ops / 10 + 1; ++i) // warm-up
+    acc += op(i % ops);
+
+  for (int r = 0; r < reps; ++r) {
+    uint64_t a0 = g_allocs;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; ++i)
+      acc += op(i);
+    auto t1 = std::chrono::steady_clock::now();
+    allocs = g_allocs - a0;
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    best_ns = std::min(best_ns, ns);
+  }
+
+  g_sink = acc;
+  return {name, best_ns / ops, (double)allocs / ops};
+}
+
+// --- Fixed corpora ---
+
+static std::vector<Card> make_deck() {
+  std::vector<Card> deck;
+  for (int r = 0; r < 13; ++r)
+    for (int s = 0; s < 4; ++s)
+      deck.emplace_back(static_cast<Rank>(r), static_cast<Suit>(s));
+  return deck;
+}
+
+struct HandSample {
+  std::vector<Card> hole;
+  std::vector<Card> board;
+  street st;
+};
+
+static std::vector<HandSample> make_hand_corpus(int n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::vector<Card> deck = make_deck();
+  const int board_sizes[4] = {0, 3, 4, 5};
+
+  std::vector<HandSample> corpus;
+  for (int i = 0; i < n; ++i) {
+    std::shuffle(deck.begin(), deck.end(), gen);
+    int st = i % 4;
+    HandSample h{{deck[0], deck[1]},
+                 std::vector<Card>(deck.begin() + 2,
+                                   deck.begin() + 2 + board_sizes[st]),
+                 static_cast<street>(st)};
+    corpus.push_back(h);
+  }
+  return corpus;
+}
+
+// Mid-hand states reached by random legal play from a 6-max start
+static std::vector<GameState> make_state_corpus(EquityModule *em, int n,
+                                                unsigned seed) {
+  std::mt19937 gen(seed);
+  std::vector<GameState> corpus;
+
+  while ((int)corpus.size() < n) {
+    GameState s(nullptr, em);
+    s.init_game_setup(6, 200, 1, 2);
+    s.start_hand(0);
+
+    std::vector<Card> deck = make_deck();
+    std::shuffle(deck.begin(), deck.end(), gen);
+    for (int p = 0; p < 6; ++p)
+      s.set_player_cards(p, {deck[2 * p], deck[2 * p + 1]});
+
+    int steps = gen() % 12;
+    for (int k = 0; k < steps && !s.is_terminal(); ++k) {
+      if (s.is_betting_round_over()) {
+        if (s.stage == Stage::RIVER)
+          break;
+        s.next_street();
+        size_t board = s.stage == Stage::FLOP ? 3 : s.community_cards.size() + 1;
+        s.set_community_cards(
+            std::vector<Card>(deck.begin() + 12, deck.begin() + 12 + board));
+        continue;
+      }
+      auto legal = s.get_legal_actions();
+      if (legal.empty())
+        break;
+      // Prefer passive actions so hands reach later streets
+      int a = gen() % 4 == 0 ? gen() % legal.size() : 1;
+      s.apply_action(legal[a], true);
+    }
+    if (!s.is_terminal() && !s.is_betting_round_over())
+      corpus.push_back(s);
+  }
+  return corpus;
+}
+
+// --- Baseline comparison ---
+
+static std::map<std::string, double> read_baseline(const std::string &fn) {
+  std::map<std::string, double> base;
+  std::ifstream in(fn);
+  std::string line;
+  while (std::getline(in, line)) {
+    auto n0 = line.find("\"name\":\"");
+    auto t0 = line.find("\"ns_per_op\":");
+    if (n0 == std::string::npos || t0 == std::string::npos)
+      continue;
+    n0 += 8;
+    std::string name = line.substr(n0, line.find('"', n0) - n0);
+    base[name] = std::atof(line.c_str() + t0 + 12);
+  }
+  return base;
+}
+
+int main(int argc, char *argv[]) {
+  std::string json_fn, baseline_fn;
+  double threshold = 10.0;
+  for (int i = 1; i + 1 < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--json")
+      json_fn = argv[++i];
+    else if (arg == "--baseline")
+      baseline_fn = argv[++i];
+    else if (arg == "--threshold")
+      threshold = std::atof(argv[++i]);
+  }
+
+  EquityModule em;
+  std::vector<BenchResult> results;
+
+  auto hands = make_hand_corpus(4096, 1234);
+  std::vector<std::vector<Card>> sevens;
+  {
+    std::mt19937 gen(99);
+    std::vector<Card> deck = make_deck();
+    for (int i = 0; i < 4096; ++i) {
+      std::shuffle(deck.begin(), deck.end(), gen);
+      sevens.emplace_back(deck.begin(), deck.begin() + 7);
+    }
+  }
+  auto states = make_state_corpus(&em, 2048, 4321);
+
+  results.push_back(run_bench("evaluate_7_cards", 4096, [&](int i) {
+    return em.evaluate_7_cards(sevens[i]);
+  }));
+
+  results.push_back(run_bench("bucketize_hand", 4096, [&](int i) {
+    const HandSample &h = hands[i];
+    return em.bucketize_hand(h.hole, h.board, h.st);
+  }));
+
+  results.push_back(run_bench("compute_information_set", 2048, [&](int i) {
+    GameState &s = states[i];
+    return (int64_t)s.compute_information_set(s.get_current_player()->id).size();
+  }));
+
+  results.push_back(run_bench("get_legal_actions", 2048, [&](int i) {
+    return (int64_t)states[i].get_legal_actions().size();
+  }));
+
+  // Six hole-card pairs plus a full board, as dealt per training iteration
+  FastRng deal_rng(7);
+  results.push_back(run_bench("deal_6max_hand", 4096, [&](int) {
+    Deck deck;
+    int64_t acc = 0;
+    for (int c = 0; c < 17; ++c)
+      acc += deck.draw_index(deal_rng);
+    return acc;
+  }));
+
+  results.push_back(run_bench("game_state_copy", 2048, [&](int i) {
+    GameState copy = states[i];
+    return (int64_t)copy.history.size();
+  }));
+
+  {
+    GameState root(nullptr, &em);
+    Trainer trainer(&root);
+    std::mt19937 gen(2024);
+    for (int i = 0; i < 500; ++i) // populate the node table first
+      trainer.traverse(5, 200, i % 5, gen);
+    results.push_back(run_bench("cfr_traversal", 200, [&](int i) {
+      return (int64_t)trainer.traverse(5, 200, i % 5, gen);
+    }));
+
+    std::vector<InfoSetKey> keys;
+    for (auto &s : states)
+      keys.push_back(s.compute_information_set(s.get_current_player()->id));
+
+    results.push_back(run_bench("strategy_lookup", 2048, [&](int i) {
+      return (int64_t)trainer.get_strategy(keys[i]).size();
+    }));
+
+    // One op = one key, amortized over batches of 256
+    std::vector<double> probs(256 * Trainer::MAX_ACTIONS);
+    std::vector<int> counts(256);
+    results.push_back(run_bench("strategy_lookup_batch", 2048, [&](int i) {
+      if (i % 256 != 0)
+        return (int64_t)0;
+      trainer.get_strategies(
+          std::span<const InfoSetKey>(keys.data() + i, 256), probs, counts);
+      return (int64_t)counts[0];
+    }));
+
+    // Opponent reweighting of a blueprint distribution, against a profiler
+    // that reads every opponent as a station
+    {
+      RiskProfiler rp;
+      for (int p = 0; p < 6; ++p) {
+        rp.add_player(p, 200);
+        for (int h = 0; h < 100; ++h) {
+          rp.reset_hand();
+          rp.update_player_profile(p, ProfileAction::CALL, 2, true, 0);
+          rp.update_player_profile(p, ProfileAction::CALL, 4, false, 0);
+        }
+      }
+      OpponentModel model;
+      std::vector<GameState> profiled = states;
+      std::vector<ActionList> legal;
+      std::vector<std::vector<double>> blueprint;
+      for (size_t i = 0; i < profiled.size(); ++i) {
+        profiled[i].risk_profiler = &rp;
+        legal.push_back(profiled[i].get_legal_actions());
+        blueprint.push_back(trainer.get_strategy(keys[i]));
+        blueprint.back().resize(legal[i].size(), 1.0 / legal[i].size());
+      }
+      std::vector<double> dist;
+      dist.reserve(Trainer::MAX_ACTIONS);
+      results.push_back(run_bench("exploit_adjust", 2048, [&](int i) {
+        dist.assign(blueprint[i].begin(), blueprint[i].end());
+        GameState &s = profiled[i];
+        return (int64_t)model.adjust(s, s.get_current_player()->id, legal[i],
+                                     dist);
+      }));
+    }
+
+    trainer.freeze();
+    results.push_back(run_bench("frozen_lookup", 2048, [&](int i) {
+      return (int64_t)trainer.get_strategy(keys[i]).size();
+    }));
+    results.push_back(run_bench("frozen_lookup_batch", 2048, [&](int i) {
+      if (i % 256 != 0)
+        return (int64_t)0;
+      trainer.get_strategies(
+          std::span<const InfoSetKey>(keys.data() + i, 256), probs, counts);
+      return (int64_t)counts[0];
+    }));
+  }
+
+  std::map<std::string, double> baseline;
+  if (!baseline_fn.empty())
+    baseline = read_baseline(baseline_fn);
+
+  bool regressed = false;
+  std::cout << std::left << std::setw(26) << "benchmark" << std::right
+            << std::setw(14) << "ns/op" << std::setw(14) << "allocs/op";
+  if (!baseline.empty())
+    std::cout << std::setw(12) << "change";
+  std::cout << "\n";
+
+  for (const auto &r : results) {
+    std::cout << std::left << std::setw(26) << r.name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14)
+              << r.ns_per_op << std::setw(14) << std::setprecision(2)
+              << r.allocs_per_op;
+    if (baseline.count(r.name) && baseline[r.name] > 0) {
+      double pct = (r.ns_per_op / baseline[r.name] - 1.0) * 100.0;
+      std::cout << std::setw(11) << std::setprecision(1) << std::showpos
+                << pct << "%" << std::noshowpos;
+      if (pct > threshold) {
+        std::cout << "  REGRESSION";
+        regressed = true;
+      }
+    }
+    std::cout << "\n";
+  }
+
+  if (!json_fn.empty()) {
+    std::ofstream out(json_fn);
+    for (const auto &r : results) {
+      out << std::fixed << std::setprecision(3) << "{\"name\":\"" << r.name
+          << "\",\"ns_per_op\":" << r.ns_per_op
+          << ",\"allocs_per_op\":" << r.allocs_per_op << "}\n";
+    }
+  }
+
+  return regressed ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+#ifndef ABSTRACTION_H
+#define ABSTRACTION_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Configurations with a compile-time specialized fast path
+enum class AbstractionPreset : uint8_t { STANDARD, COMPACT, CUSTOM };
+
+// Game abstraction used for action generation, info-set keys and training
+// sampling. Loaded from a text file at startup and saved with the model,
+// since keys of a model are only meaningful under the abstraction that
+// built them.
+//
+//   # comments and blank lines are ignored
+//   preset = standard            # starting point (standard | compact)
+//   bet_sizes = 0.33 0.66 1 2    # pot fractions on every street
+//   bet_sizes.river = 0.5 1 2    # ... or per street (preflop flop turn river)
+//   stack_bounds = 10 25 50 100  # big blinds, one bucket per interval
+//   pot_bounds = 5 15 30 60      # big blinds
+//   bet_size_bounds = 0.4 0.75 1.5 2.5  # pot fractions of history letters
+//   player_counts = 5            # table sizes sampled in training
+//   stack_mix = 10 25 50 100 200 # starting stacks sampled in training (bb);
+//                                # repeat a value to weight it
+struct AbstractionConfig {
+  static constexpr int NUM_STREETS = 4;
+  // Fold, check/call and all-in leave this many of ActionList::MAX_ACTIONS
+  static constexpr int MAX_BET_SIZES = 5;
+  static constexpr int MAX_BOUNDS = 7;
+  // History letters for bet_size_bounds intervals, smallest first
+  static constexpr const char *BET_LETTERS = "SMPLAXYZ";
+  // Stack buckets the preflop chart has room for
+  static constexpr int MAX_STACK_BUCKETS = 5;
+
+  std::vector<double> bet_sizes[NUM_STREETS];
+  std::vector<double> stack_bounds;
+  std::vector<double> pot_bounds;
+  std::vector<double> bet_size_bounds;
+  std::vector<int> player_counts;
+  std::vector<double> stack_mix;
+
+  // Preset whose constants equal the fields above, CUSTOM otherwise
+  AbstractionPreset preset = AbstractionPreset::STANDARD;
+
+  static AbstractionConfig standard();
+  static AbstractionConfig compact();
+
+  // Text format above; errors are reported against `source`
+  bool read(std::istream &in, const std::string &source);
+  bool load(const std::string &filename);
+  void write(std::ostream &out) const;
+
+  // Model file section (u32 tag, u64 size, text payload)
+  static constexpr uint32_t SECTION_TAG = 0x54534241; // "ABST"
+  void write_section(std::ostream &out) const;
+
+  int num_stack_buckets() const { return (int)stack_bounds.size() + 1; }
+
+  bool same_abstraction(const AbstractionConfig &o) const;
+
+private:
+  bool validate(const std::string &source) const;
+  void detect_preset();
+};
+
+// Abstraction in effect for the whole process. Set it before any state is
+// built or worker started; loading a model replaces it with the model's.
+const AbstractionConfig &active_abstraction();
+void set_active_abstraction(const AbstractionConfig &cfg);
+
+//
+// Compile-time views of the presets and a runtime view of any config. Code
+// on the hot path is written once against this interface and instantiated
+// per preset, so the common configurations see constant tables.
+//
+
+struct StandardAbstraction {
+  static constexpr double BET_SIZES[] = {0.33, 0.66, 1.00, 2.00};
+  static constexpr double STACK_BOUNDS[] = {10, 25, 50, 100};
+  static constexpr double POT_BOUNDS[] = {5, 15, 30, 60};
+  static constexpr double BET_SIZE_BOUNDS[] = {0.4, 0.75, 1.5, 2.5};
+
+  static constexpr std::span<const double> bet_sizes(int) { return BET_SIZES; }
+  static constexpr std::span<const double> stack_bounds() {
+    return STACK_BOUNDS;
+  }
+  static constexpr std::span<const double> pot_bounds() { return POT_BOUNDS; }
+  static constexpr std::span<const double> bet_size_bounds() {
+    return BET_SIZE_BOUNDS;
+  }
+};
+
+// Half-pot and pot bets only; same buckets as the standard abstraction
+struct CompactAbstraction : StandardAbstraction {
+  static constexpr double BET_SIZES[] = {0.5, 1.0};
+
+  static constexpr std::span<const double> bet_sizes(int) { return BET_SIZES; }
+};
+
+struct RuntimeAbstraction {
+  const AbstractionConfig &cfg;
+
+  std::span<const double> bet_sizes(int street) const {
+    return cfg.bet_sizes[street];
+  }
+  std::span<const double> stack_bounds() const { return cfg.stack_bounds; }
+  std::span<const double> pot_bounds() const { return cfg.pot_bounds; }
+  std::span<const double> bet_size_bounds() const {
+    return cfg.bet_size_bounds;
+  }
+};
+
+// Number of bounds at or below `value`, i.e. the bucket it falls in
+constexpr int abstraction_bucket(double value, std::span<const double> bounds) {
+  int b = 0;
+  while (b < (int)bounds.size() && value >= bounds[b])
+    b++;
+  return b;
+}
+
+// Calls f with the view matching `cfg` (a preset type when possible)
+template <class F>
+decltype(auto) with_abstraction(const AbstractionConfig &cfg, F &&f) {
+  switch (cfg.preset) {
+  case AbstractionPreset::STANDARD:
+    return f(StandardAbstraction{});
+  case AbstractionPreset::COMPACT:
+    return f(CompactAbstraction{});
+  default:
+    return f(RuntimeAbstraction{cfg});
+  }
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef DECISION_IO_H
+#define DECISION_IO_H
+
+#include "equity.h"
+#include "game_state.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Trainer;
+
+// Card parsing ("Ah", "Td", ...)
+Card parse_card(const std::string &s);
+std::vector<Card> parse_cards(const std::string &line);
+
+// One decision point, as read by the batch solver:
+//
+//   id=17 players=6 dealer=0 sb=1 bb=2 stacks=200,200,150,200,200,200
+//   hero=3 hole=AhKd board=Qs7c2d actions=c,c,r6,f,c
+//
+// `stacks` may be a single value for every seat. `actions` replays the hand
+// from the blinds: f fold, x check, c check/call, b<amt>/r<amt> bet or
+// raise to <amt>, a all-in. Board cards are revealed street by street as
+// the betting rounds close.
+struct DecisionRecord {
+  std::string id;
+  int num_players = 0;
+  int dealer = 0;
+  double sb = 1.0;
+  double bb = 2.0;
+  std::vector<double> stacks;
+  int hero = 0;
+  std::vector<Card> hole;
+  std::vector<Card> board;
+  std::vector<std::string> actions;
+};
+
+bool parse_decision_record(std::string_view line, DecisionRecord &rec,
+                           std::string &error);
+
+// Sets up `state` and replays the record up to the hero's decision
+bool replay_decision(const DecisionRecord &rec, GameState &state,
+                     std::string &error);
+
+// Maps solver-mode style action text to an Action for the current player
+Action parse_action(const GameState &state, const std::string &text);
+
+const char *action_name(ActionType type);
+
+struct BatchConfig {
+  int workers = 1;
+  int equity_samples = 200; // 0 disables the equity estimate
+  size_t block_size = 4096; // records per block handed to the workers
+};
+
+// Reads records line by line and writes one JSON line per record, in input
+// order: the legal actions with their probabilities and the hero's equity.
+// Returns the number of records that failed to parse or replay.
+size_t run_batch(Trainer &trainer, std::istream &in, std::ostream &out,
+                 const BatchConfig &cfg);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef DECISION_SERVER_H
+#define DECISION_SERVER_H
+
+#include "decision_io.h"
+#include "latency.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Trainer;
+
+// Long-running decision server. Keeps the model resident and answers framed
+// binary requests over a Unix domain socket or localhost TCP.
+//
+// Every frame is a little-endian u32 payload length followed by the payload.
+//
+// Request payload:
+//   u32 request_id
+//   u8  num_players, dealer, hero, num_board, num_actions
+//   u8  reserved
+//   u16 equity_samples (0 = no equity)
+//   f32 sb, bb
+//   f32 stacks[num_players]
+//   u8  hole[2]                  card = rank * 4 + suit
+//   u8  board[num_board]
+//   { u8 code, f32 amount }[num_actions]   code: 'f' 'x' 'c' 'b' 'r' 'a'
+//
+// Response payload:
+//   u32 request_id
+//   u8  status                   ServerStatus
+//   u8  source                   0 uniform, 1 blueprint
+//   u8  num_actions
+//   u8  reserved
+//   f32 equity
+//   { u8 type, f32 amount, f32 prob }[num_actions]   type: ActionType
+//   (status != OK: u16 length + error text instead of the action list)
+enum class ServerStatus : uint8_t { OK = 0, BAD_REQUEST = 1, NO_DECISION = 2 };
+
+struct ServerConfig {
+  std::string unix_path; // used when non-empty
+  int tcp_port = 0;      // otherwise listen on 127.0.0.1:<port>
+  int workers = 2;
+  int report_interval_s = 10;
+};
+
+// Decodes a request payload into a DecisionRecord
+bool decode_request(const uint8_t *data, size_t len, uint32_t &request_id,
+                    int &equity_samples, DecisionRecord &rec,
+                    std::string &error);
+
+// Solves one request payload and returns the response payload
+std::vector<uint8_t> handle_request(const Trainer &trainer, EquityModule &em,
+                                    const uint8_t *data, size_t len);
+
+// Runs the epoll loop until SIGINT/SIGTERM. Returns 0 on clean shutdown.
+int run_decision_server(const Trainer &trainer, const ServerConfig &cfg);
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef DECK_H
+#define DECK_H
+
+#include "equity.h"
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// xoshiro256** seeded through splitmix64. Satisfies UniformRandomBitGenerator,
+// so it also drives the standard distributions.
+class FastRng {
+public:
+  using result_type = uint64_t;
+
+  explicit FastRng(uint64_t seed = 0x9E3779B97F4A7C15ull) { reseed(seed); }
+
+  void reseed(uint64_t seed) {
+    for (auto &w : s) {
+      seed += 0x9E3779B97F4A7C15ull;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      w = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    uint64_t result = std::rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = std::rotl(s[3], 45);
+    return result;
+  }
+
+private:
+  uint64_t s[4];
+};
+
+// The 52 cards as a bitmask of live cards (bit = rank * 4 + suit). Copying a
+// deck is one word, dealing k cards is O(k) expected and never allocates.
+class Deck {
+public:
+  static constexpr int SIZE = 52;
+  static constexpr uint64_t FULL = (1ull << SIZE) - 1;
+
+  Deck() : live(FULL) {}
+
+  static int index(const Card &c) { return (int)c.rank * 4 + (int)c.suit; }
+  static Card card(int idx) { return Card((Rank)(idx >> 2), (Suit)(idx & 3)); }
+
+  void reset() { live = FULL; }
+  int size() const { return std::popcount(live); }
+  bool contains(const Card &c) const { return (live >> index(c)) & 1; }
+
+  void remove(const Card &c) { live &= ~(1ull << index(c)); }
+  void remove(const std::vector<Card> &cards) {
+    for (const auto &c : cards)
+      remove(c);
+  }
+
+  // Removes and returns a uniformly chosen live card (the deck must not be
+  // empty). Works with any 32- or 64-bit UniformRandomBitGenerator.
+  template <class Rng> Card draw(Rng &rng) { return card(draw_index(rng)); }
+
+  template <class Rng> int draw_index(Rng &rng) {
+    // Rejection sampling while the deck is dense (a Hold'em hand never uses
+    // more than 17 cards); rank selection once it thins out
+    if (size() >= SIZE / 2) {
+      while (true) {
+        int idx = (int)below(rng, SIZE);
+        if ((live >> idx) & 1) {
+          live &= ~(1ull << idx);
+          return idx;
+        }
+      }
+    }
+
+    uint64_t bits = live;
+    for (uint32_t r = below(rng, size()); r > 0; --r)
+      bits &= bits - 1;
+    int idx = std::countr_zero(bits);
+    live &= ~(1ull << idx);
+    return idx;
+  }
+
+  // Appends k cards to `out`
+  template <class Rng> void draw(Rng &rng, int k, std::vector<Card> &out) {
+    for (int i = 0; i < k; ++i)
+      out.push_back(draw(rng));
+  }
+
+private:
+  uint64_t live;
+
+  // Multiply-shift reduction of 32 random bits to [0, n); the bias is below
+  // n / 2^32, far under sampling noise for n <= 52
+  template <class Rng> static uint32_t below(Rng &rng, uint32_t n) {
+    static_assert(Rng::min() == 0 && Rng::max() >= 0xFFFFFFFFull,
+                  "generator must produce at least 32 random bits");
+    uint32_t x = (uint32_t)(rng() >> (std::bit_width((uint64_t)Rng::max()) - 32));
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+  }
+};
+
+#endif
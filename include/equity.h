@@ -2,6 +2,7 @@
 #define EQUITY_MODULE_H
 
 #include <array>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -63,18 +64,36 @@ enum BucketID {
 
 enum street { PRE, FLOP, TURN, RIVER };
 
+// Allocation-free hand summary: rank counts and a rank bitmask per suit.
+// Cards can be added incrementally, so a shared board is summarized once and
+// copied per hand. score() equals evaluate_7_cards on the same 5-7 cards.
+struct HandMask {
+  uint16_t suits[4] = {0, 0, 0, 0};
+  uint8_t counts[13] = {};
+  int num_cards = 0;
+
+  void add(const Card &c) {
+    suits[c.suit] |= (uint16_t)(1u << c.rank);
+    counts[c.rank]++;
+    num_cards++;
+  }
+  int score() const;
+};
+
 class EquityModule {
 public:
   // Core bucketization for MCCFR
   int bucketize_hand(const std::vector<Card> &hero_hand,
                      const std::vector<Card> &board_cards, street street);
 
-  // Hand evaluation helper
+  // Hand evaluation helper (best 5 of 5-7 cards; see HandMask)
   int evaluate_7_cards(const std::vector<Card> &cards);
 
-  // New: Display-focused equity calculation (Monte Carlo)
+  // New: Display-focused equity calculation (Monte Carlo, 1000 samples are
+  // enough for display precision)
   double calculate_display_equity(const std::vector<Card> &hero_hand,
-                                  const std::vector<Card> &board_cards);
+                                  const std::vector<Card> &board_cards,
+                                  int iterations = 1000);
 
 private:
   int evaluate_5_cards(const std::vector<Card> &cards);
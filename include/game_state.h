@@ -1,9 +1,12 @@
 #ifndef GAME_STATE_MODULE_H
 #define GAME_STATE_MODULE_H
 
+#include "abstraction.h"
 #include "equity.h"
 #include "risk_profiler.h"
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <random>
 #include <string>
@@ -20,7 +23,7 @@ enum class Stage {
   SHOWDOWN,
 };
 
-enum class ActionType { FOLD, CHECK, CALL, BET, RAISE, ALLIN };
+enum class ActionType : uint8_t { FOLD, CHECK, CALL, BET, RAISE, ALLIN };
 
 // Minimal player struct for MCCFR
 struct Player {
@@ -48,6 +51,59 @@ struct Action {
       : player_id(pid), type(t), amount(amt), previous_bet(0) {}
 };
 
+// Legal actions of one decision, stored inline. The abstraction offers at
+// most MAX_ACTIONS and every entry belongs to the same player, so a slot only
+// holds the action type and amount; Actions are materialized on access.
+class ActionList {
+public:
+  static constexpr int MAX_ACTIONS = 8;
+  // Fold, check/call, every bet size and all-in must fit
+  static_assert(AbstractionConfig::MAX_BET_SIZES + 3 <= MAX_ACTIONS,
+                "ActionList cannot hold every abstract action");
+
+  ActionList() : player_id(-1), count(0) {}
+  explicit ActionList(int pid) : player_id(pid), count(0) {}
+
+  // The static_assert above and the bet-size limit enforced when an
+  // abstraction is loaded keep count below MAX_ACTIONS
+  void push_back(ActionType t, double amount) {
+    assert(count < MAX_ACTIONS && "more legal actions than MAX_ACTIONS");
+    types[count] = t;
+    amounts[count] = amount;
+    count++;
+  }
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  Action operator[](size_t i) const {
+    return Action(player_id, types[i], amounts[i]);
+  }
+
+  class iterator {
+  public:
+    iterator(const ActionList *l, size_t i) : list(l), idx(i) {}
+    Action operator*() const { return (*list)[idx]; }
+    iterator &operator++() {
+      ++idx;
+      return *this;
+    }
+    bool operator!=(const iterator &o) const { return idx != o.idx; }
+
+  private:
+    const ActionList *list;
+    size_t idx;
+  };
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, count); }
+
+private:
+  int player_id;
+  uint8_t count;
+  ActionType types[MAX_ACTIONS];
+  double amounts[MAX_ACTIONS];
+};
+
 enum class StateType { CHANCE, PLAY, TERMINAL };
 
 struct GameState {
@@ -91,19 +147,32 @@ struct GameState {
 
   // Actions
   bool record_action(int player_idx, Action action, bool is_train);
-  std::vector<Action> get_legal_actions();
+  // Under the active abstraction unless another one is given
+  ActionList
+  get_legal_actions(const AbstractionConfig &abs = active_abstraction());
   void apply_action(Action action, bool is_train);
 
   // MCCFR Support
   bool is_terminal();
-  string compute_information_set(int player_id);
+  // num_legal: size of the current legal action list when the caller already
+  // has it (computed here otherwise)
+  string compute_information_set(int player_id, int num_legal = -1);
+  string
+  compute_public_key(int player_id, int num_legal = -1,
+                     const AbstractionConfig &abs = active_abstraction());
   Player *get_player(int player_id);
 
   // Abstraction Helpers
-  int abstract_stack_size(double stack_bb) const;
-  int abstract_pot_size(double pot_bb) const;
-  std::string abstract_bet_size(double bet_amount) const;
-  std::string abstract_action_history() const;
+  int abstract_stack_size(
+      double stack_bb,
+      const AbstractionConfig &abs = active_abstraction()) const;
+  int abstract_pot_size(
+      double pot_bb, const AbstractionConfig &abs = active_abstraction()) const;
+  char abstract_bet_size(
+      double bet_amount,
+      const AbstractionConfig &abs = active_abstraction()) const;
+  std::string abstract_action_history(
+      const AbstractionConfig &abs = active_abstraction()) const;
 
   // Helpers
   int get_active_player_count();
@@ -0,0 +1,44 @@
+#ifndef HAND_HISTORY_H
+#define HAND_HISTORY_H
+
+#include "risk_profiler.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Opponent profiles by player name, built from hand histories before a
+// session and handed to RiskProfiler seat by seat
+using ProfileBook = std::unordered_map<std::string, PlayerProfile>;
+
+// Hand-history log, one hand per line (blank lines and # comments are
+// skipped, unknown fields ignored):
+//
+//   seats=alice,bob,carol,dave preflop=dave:r6,alice:f,bob:c,carol:c
+//   flop=bob:x,carol:b4,dave:c,bob:f turn=carol:x,dave:x river=...
+//
+// `seats` lists everyone dealt in; each street lists name:action with the
+// batch-record codes (f fold, x check, c call, b<amt>/r<amt> bet or raise,
+// a all-in). A bare `a` counts as a bet or raise; write `ac` for an all-in
+// that only calls, which RiskProfiler counts as a call at the table.
+struct ImportConfig {
+  int workers = 1;
+};
+
+struct ImportStats {
+  uint64_t hands = 0;
+  uint64_t actions = 0;
+  uint64_t malformed = 0; // lines skipped
+  uint64_t bytes = 0;
+};
+
+// Maps the file and tokenizes it in place, one newline-aligned chunk per
+// worker, then merges the per-worker profiles into `book`. False when the
+// file cannot be read.
+bool import_hand_history(const std::string &filename, ProfileBook &book,
+                         const ImportConfig &cfg, ImportStats &stats);
+
+// Text file with one profile per line: name and counters
+bool load_profiles(const std::string &filename, ProfileBook &book);
+bool save_profiles(const std::string &filename, const ProfileBook &book);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Thread-safe collection of per-decision latencies (milliseconds)
+class LatencyRecorder {
+private:
+  mutable std::mutex mtx;
+  std::vector<double> samples;
+
+public:
+  void record(double ms);
+  void reset();
+
+  size_t count() const;
+  // p in [0, 100]; 0 when nothing was recorded
+  double percentile(double p) const;
+
+  // "n=.. p50=..ms p90=..ms p99=..ms max=..ms"
+  std::string summary() const;
+};
+
+#endif
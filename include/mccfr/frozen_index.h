@@ -0,0 +1,83 @@
+#ifndef FROZEN_INDEX_H
+#define FROZEN_INDEX_H
+
+#include "node.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Read-only info-set index for serving a trained blueprint. A minimal
+// perfect hash (PTHash/CHD style: keys hashed into buckets of ~4, each
+// bucket gets a 16-bit pilot that scatters its keys onto free slots) maps
+// every trained key to its own slot in a flat entry array laid out in hash
+// order. Keys themselves are not stored; a 32-bit fingerprint per entry
+// rejects unknown keys (false positive rate 2^-32).
+//
+// A lookup hashes the key once, reads its bucket's pilot and then the entry:
+// two cache misses. Keys whose slot falls past the end of the table (~2%)
+// go through one small remap array on the way. The index costs ~4.7 bits
+// per key on top of the entries.
+class FrozenIndex {
+public:
+  static constexpr int SLOTS = 8; // Trainer::MAX_ACTIONS
+
+  // Average strategy of one info set, quantized to 1/65535 steps that sum
+  // to exactly 65535
+  struct alignas(32) Entry {
+    uint32_t fingerprint;
+    uint8_t num_actions;
+    uint16_t probs[SLOTS];
+  };
+
+  // Replaces the index with one over every node of `nodes`. False when no
+  // perfect hash could be found (practically never).
+  bool build(const std::unordered_map<std::string, Node *> &nodes);
+
+  bool empty() const { return entries.empty(); }
+  size_t size() const { return entries.size(); }
+
+  // Entry of `key`, or nullptr when it was not part of the build
+  const Entry *find(std::string_view key) const { return find(hash(key)); }
+
+  // Staged form for batched lookups: hash a window of keys and prefetch
+  // their pilots, then fetch their candidate entries, then check them
+  uint64_t hash(std::string_view key) const;
+  void prefetch(uint64_t h) const {
+    __builtin_prefetch(&pilots[bucket_of(h)]);
+  }
+  // Entry a key hashed to h would occupy (index must not be empty)
+  const Entry &candidate(uint64_t h) const;
+  static bool matches(const Entry &e, uint64_t h) {
+    return e.fingerprint == (uint32_t)h;
+  }
+  const Entry *find(uint64_t h) const {
+    if (entries.empty())
+      return nullptr;
+    const Entry &e = candidate(h);
+    return matches(e, h) ? &e : nullptr;
+  }
+
+  // Writes num_actions probabilities to out, returns the count
+  static int write_strategy(const Entry &e, double *out);
+
+  // Pilots and remap array, without the entries
+  size_t index_bytes() const;
+  size_t entry_bytes() const { return entries.size() * sizeof(Entry); }
+
+private:
+  uint64_t seed = 0;
+  uint64_t num_buckets = 0;
+  uint64_t table_size = 0; // slots the pilots address, >= size()
+  std::vector<uint16_t> pilots;
+  std::vector<uint32_t> remap; // slot of position size() + i
+  std::vector<Entry> entries;
+
+  uint64_t bucket_of(uint64_t h) const {
+    return ((h >> 32) * num_buckets) >> 32;
+  }
+  static uint64_t position(uint64_t h, uint16_t pilot, uint64_t table_size);
+};
+
+#endif
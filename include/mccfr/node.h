@@ -1,27 +1,51 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include <cstddef>
 #include <vector>
 
 class Node {
 private:
   int num_actions;
-  std::vector<double> regret_sum;
-  std::vector<double> strategy;
-  std::vector<double> strategy_sum;
+  bool owns_values;
+  // regret_sum and strategy_sum, num_actions values each
+  double *values;
+
+  double *regret_sum() const { return values; }
+  double *strategy_sum() const { return values + num_actions; }
 
 public:
   explicit Node(int n);
+  // Keeps its values in caller-owned memory of values_size(n) bytes (an
+  // arena chunk), which must outlive the node
+  Node(int n, double *storage);
+
+  ~Node();
+
+  Node(const Node &) = delete;
+  Node &operator=(const Node &) = delete;
 
-  ~Node() = default;
+  static size_t values_size(int n) { return 2 * sizeof(double) * n; }
 
   std::vector<double> get_strategy(double realization_weight);
+  // Allocation-free variant; writes num_actions values to out (the node
+  // keeps no copy of the current strategy)
+  void get_strategy(double realization_weight, double *out);
   std::vector<double> get_average_strategy();
+  // Allocation-free variant; writes num_actions values, returns the count
+  int write_average_strategy(double *out) const;
+  // Pulls the strategy sums toward the cache ahead of a batched read
+  void prefetch() const { __builtin_prefetch(strategy_sum()); }
   std::vector<double>
   get_strategy_sum() const; // NEW: getter for raw strategy_sum
+  std::vector<double> get_regret_sum() const;
+  // Largest cumulative regret, 0 when none is positive
+  double get_max_regret() const;
+  int get_num_actions() const { return num_actions; }
 
   void update_regret_sum(int action, double regret);
   void set_strategy_sum(const std::vector<double> &strat_sum);
+  void set_regret_sum(const std::vector<double> &regrets);
 };
 
 #endif
\ No newline at end of file
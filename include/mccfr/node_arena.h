@@ -0,0 +1,78 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include "node.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Page size behind the node store
+enum class HugePages : uint8_t {
+  OFF,         // regular 4 KB pages
+  TRANSPARENT, // madvise(MADV_HUGEPAGE) on 2 MB aligned chunks
+  EXPLICIT     // MAP_HUGETLB from the reserved pool, else TRANSPARENT
+};
+
+// NUMA placement of the node store
+enum class NumaPolicy : uint8_t {
+  FIRST_TOUCH, // pages land on the node of the thread that first writes them
+  INTERLEAVE   // pages are spread round-robin over all memory nodes
+};
+
+struct ArenaConfig {
+  HugePages huge_pages = HugePages::TRANSPARENT;
+  NumaPolicy numa = NumaPolicy::FIRST_TOUCH;
+  size_t chunk_bytes = 64 << 20; // rounded up to 2 MB
+};
+
+// Bump allocator for training nodes. Memory comes from large anonymous
+// mappings, so the random node accesses of a big run walk few TLB entries
+// (2 MB pages) and, on multi-socket machines, can be interleaved across
+// memory controllers. Each node and its values are allocated back to back.
+// Nothing is freed individually: reset() drops every node at once. Not
+// thread-safe; one arena per trainer, like its node table.
+class NodeArena {
+public:
+  explicit NodeArena(const ArenaConfig &cfg = ArenaConfig());
+  ~NodeArena();
+
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+
+  // Applies to chunks mapped from now on
+  void configure(const ArenaConfig &cfg) { config = cfg; }
+  const ArenaConfig &get_config() const { return config; }
+
+  Node *create(int num_actions);
+
+  // Drops every node (arena nodes own nothing, so no destructors run) and
+  // unmaps every chunk
+  void reset();
+
+  size_t num_chunks() const { return chunks.size(); }
+  size_t mapped_bytes() const { return mapped; }
+  size_t used_bytes() const { return used; }
+  // Chunks backed by MAP_HUGETLB / advised for transparent huge pages
+  size_t hugetlb_chunks() const { return hugetlb; }
+  size_t advised_chunks() const { return advised; }
+  size_t interleaved_chunks() const { return interleaved; }
+  // Requests the kernel refused (hugetlb pool empty, no NUMA support, ...)
+  size_t fallbacks() const { return failed; }
+
+private:
+  struct Chunk {
+    void *base;
+    size_t size;
+  };
+
+  ArenaConfig config;
+  std::vector<Chunk> chunks;
+  char *cursor;
+  char *limit;
+  size_t mapped, used;
+  size_t hugetlb, advised, interleaved, failed;
+
+  void map_chunk(size_t min_bytes);
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef OPPONENT_MODEL_H
+#define OPPONENT_MODEL_H
+
+#include "game_state.h"
+#include "risk_profiler.h"
+#include <cstdint>
+#include <vector>
+
+struct ExploitConfig {
+  double strength = 0.5;     // share of the full archetype response, 0..1
+  double prior_hands = 30;   // hands of evidence worth half the strength
+  StatWindow window = StatWindow::DECAYED;
+};
+
+// Exploitative layer over the blueprint. Opponents are classified from
+// their RiskProfiler stats into a few archetypes; each archetype has a
+// precomputed response, a multiplier per action class for spots facing a
+// bet and for spots without one. The blueprint distribution is reweighted
+// by that response, scaled by how much evidence the profile holds, and
+// renormalized. With no profile data the blueprint passes unchanged.
+class OpponentModel {
+public:
+  enum class Archetype : uint8_t {
+    BALANCED, // no adjustment
+    NIT,      // tight: folds too much, bets mean strength
+    STATION,  // loose-passive: calls too much, bets mean strength
+    MANIAC,   // loose-aggressive: bets and raises too much
+    COUNT
+  };
+
+  // Thresholds on the profile stats
+  static constexpr double TIGHT_VPIP = 0.18;
+  static constexpr double LOOSE_VPIP = 0.35;
+  static constexpr double PASSIVE_AF = 1.0;
+  static constexpr double AGGRESSIVE_AF = 2.5;
+
+  explicit OpponentModel(const ExploitConfig &cfg = ExploitConfig());
+
+  static Archetype classify(const ProfileStats &stats);
+  static const char *archetype_name(Archetype a);
+
+  // Reweights `probs` (one entry per legal action) in place for
+  // `player_id` against the opponents profiled in state.risk_profiler.
+  // Returns the archetype responded to.
+  Archetype adjust(const GameState &state, int player_id,
+                   const ActionList &legal, std::vector<double> &probs) const;
+
+  const ExploitConfig &get_config() const { return cfg; }
+
+private:
+  // Action classes the responses are written over
+  enum ActionClass { FOLD, PASSIVE, SMALL_BET, BIG_BET, NUM_CLASSES };
+  // Whether the player faces a real bet (blinds do not count)
+  enum Spot { OPEN, FACING, NUM_SPOTS };
+
+  static const double RESPONSES[(int)Archetype::COUNT][NUM_SPOTS]
+                               [NUM_CLASSES];
+
+  ExploitConfig cfg;
+
+  // Stats the response is chosen from: the player who made the last bet or
+  // raise when facing one, otherwise the live opponents pooled
+  ProfileStats opponent_stats(const GameState &state, int player_id,
+                              Spot spot) const;
+};
+
+#endif
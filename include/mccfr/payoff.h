@@ -0,0 +1,20 @@
+#ifndef PAYOFF_H
+#define PAYOFF_H
+
+// Largest table the settlement scratch arrays hold
+static constexpr int MAX_SEATS = 10;
+
+// Settles a finished hand with main and side pots.
+//
+// contrib[i] is everything seat i put in the pot this hand, folded[i] marks
+// seats out of the hand and ranks[i] is the final hand rank of each live
+// seat. Each pot layer (the amount between two consecutive contribution
+// levels) is split evenly among the best live hands of the seats that reached
+// that level; a layer nobody live reached goes back to its contributors.
+//
+// Writes the net result (winnings minus contribution) of every seat to
+// payoff. num_players must not exceed MAX_SEATS; nothing is allocated.
+void settle_pots(int num_players, const double *contrib, const bool *folded,
+                 const int *ranks, double *payoff);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef PREFLOP_CHART_H
+#define PREFLOP_CHART_H
+
+#include "../abstraction.h"
+#include "equity.h"
+#include "game_state.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+class Trainer;
+
+// Dense copy of the blueprint's first preflop decisions. A cell is one
+// public spot: player count, relative position, stack and pot buckets and
+// the exact abstract history of the seats before the hero; it holds the
+// blueprint strategy of every preflop hand bucket. Cells are built along the
+// lines the blueprint plays, so a lookup is a binary search over integer
+// keys and one indexed load instead of an info-set string and a hash probe.
+class PreflopChart {
+public:
+  static constexpr int MIN_PLAYERS = 2;
+  static constexpr int MAX_PLAYERS = 6;
+  static constexpr int NUM_BUCKETS = 10; // preflop BucketIDs
+  static constexpr int SLOTS = 8;        // Trainer::MAX_ACTIONS
+  // Lines are followed through at most this many bets and raises, and
+  // through calls and raises the blueprint makes this often on average
+  static constexpr int MAX_RAISES = 2;
+  static constexpr double MIN_LINE_FREQ = 0.05;
+
+  struct Entry {
+    float probs[SLOTS];
+    uint8_t num_actions; // 0 = the blueprint has no node for this bucket
+  };
+
+  PreflopChart();
+
+  bool empty() const { return !built; }
+  size_t num_cells() const { return keys.size(); }
+
+  // Walks the preflop lines from the blinds for every table size and stack
+  // bucket and copies the blueprint strategy of each first decision
+  void build(const Trainer &trainer, EquityModule *em);
+
+  // Blueprint strategy over `legal` for the current decision, or nullptr
+  // when the spot has no cell (postflop, hero already acted, a line the
+  // chart does not follow, other legal actions, no blueprint node, ...)
+  const Entry *lookup(GameState &state, int player_id,
+                      const ActionList &legal) const;
+
+  // 13x13 grids of aggressive frequency for the unopened and single-raise
+  // cells of a table size and stack bucket
+  void print(std::ostream &os, int num_players, int stack_bucket) const;
+
+  // Model file section payload
+  void write(std::ostream &out) const;
+  bool read(std::istream &in);
+
+private:
+  bool built;
+  std::vector<uint64_t> keys;        // sorted cell keys
+  std::vector<uint8_t> cell_actions; // ActionType per slot, per cell
+  std::vector<Entry> entries;        // NUM_BUCKETS per cell
+
+  // Packs the public spot of the player's first preflop decision; false
+  // when it is not one
+  static bool cell_key(GameState &state, int player_id, uint64_t &key);
+  int find_cell(uint64_t key) const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef RANGE_TRAINER_H
+#define RANGE_TRAINER_H
+
+#include "game_state.h"
+#include "node.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+class Trainer;
+
+struct RangeConfig {
+  Stage start = Stage::RIVER; // first street solved over full ranges
+  double stack_bb = 100;      // starting stacks of both seats
+  int max_raises = 2;         // bets + raises per street inside the tree
+};
+
+// Heads-up CFR over the public tree with full hand ranges. Each iteration
+// samples one board, plays a short public betting line up to the start
+// street and then walks every public node once per traverser, carrying a
+// reach probability for each of the 1326 hole-card combos instead of one
+// sampled hand. Regrets are aggregated per hand bucket into the blueprint's
+// own nodes, so the result refines the same model the sampled trainer builds.
+class RangeTrainer {
+public:
+  static constexpr int NUM_COMBOS = 1326;
+  static constexpr int NUM_BUCKETS = 10;
+
+  RangeTrainer(Trainer &blueprint, const RangeConfig &cfg);
+
+  void train(int iterations);
+
+  // Public nodes visited by the last call to train()
+  uint64_t get_nodes_visited() const { return nodes_visited; }
+
+private:
+  Trainer &blueprint;
+  RangeConfig cfg;
+  GameState root;
+  std::mt19937 gen;
+  uint64_t nodes_visited;
+
+  // Board of the current iteration and, per combo, whether it is dealt
+  // around it, its bucket on each street and its river hand rank
+  int board[5];
+  uint8_t valid[NUM_COMBOS];
+  uint8_t buckets[4][NUM_COMBOS];
+  int ranks[NUM_COMBOS];
+  int num_valid;
+
+  // Valid combos by ascending rank, split into groups of equal rank
+  std::vector<int> by_rank;
+  std::vector<int> group_end;
+  std::vector<double> stronger; // showdown scratch
+
+  // Per-depth scratch: child reach, per-action values and the strategy
+  // expanded to every combo
+  std::vector<std::vector<double>> frames;
+  double *frame(int depth);
+
+  // Draws the board and fills everything above for it
+  void deal_board();
+
+  // Shows the cards of the next street and moves the state onto it
+  void reveal_next_street(GameState &state);
+
+  // Samples the public line up to cfg.start and weights both ranges by the
+  // blueprint along it; false if the hand ended before the start street
+  bool play_prefix(GameState &state, double *reach0, double *reach1);
+
+  // Counterfactual value of every traverser combo (written to `values`)
+  void walk(GameState &state, int traverser, const double *own_reach,
+            const double *opp_reach, double *values, int raises, int depth);
+
+  void fold_values(GameState &state, int traverser, const double *opp_reach,
+                   double *values);
+  void showdown_values(GameState &state, int traverser,
+                       const double *opp_reach, double *values);
+
+  // Bucket strategies at a public node; nodes are created on first visit
+  // (row b of `sig` holds bucket b, stride Trainer::MAX_ACTIONS)
+  void bucket_strategies(GameState &state, int player, int num_actions,
+                         const double *reach, bool accumulate, Node **nodes,
+                         double *sig);
+};
+
+#endif
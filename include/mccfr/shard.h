@@ -0,0 +1,80 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "node_arena.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct GameState;
+
+// On-disk node table used by sharded training. Records are
+// (key, regret_sum, strategy_sum) sorted by key, so tables can be merged
+// with a streaming k-way merge.
+struct TableRecord {
+  std::string key;
+  std::vector<double> regret_sum;
+  std::vector<double> strategy_sum;
+};
+
+class TableWriter {
+private:
+  std::ofstream out;
+
+public:
+  explicit TableWriter(const std::string &filename);
+
+  bool ok() const { return (bool)out; }
+
+  // Keys must be written in ascending order
+  void write(const std::string &key, const std::vector<double> &regret_sum,
+             const std::vector<double> &strategy_sum);
+  bool close();
+};
+
+class TableReader {
+private:
+  std::ifstream in;
+  bool has_record;
+
+public:
+  TableRecord record;
+
+  explicit TableReader(const std::string &filename);
+
+  bool is_open() const { return in.is_open(); }
+  bool ok() const { return has_record; }
+
+  // Loads the next record into `record`; returns false at end of table
+  bool next();
+};
+
+struct ShardConfig {
+  std::string dir;
+  int num_shards;
+  int rounds;
+  int iterations_per_round;
+  unsigned base_seed;
+  bool presample_runouts = false;
+  ArenaConfig node_store;
+};
+
+// Path of the merged table published after `round` (round -1 = none)
+std::string shard_model_path(const ShardConfig &cfg, int round);
+std::string shard_delta_path(const ShardConfig &cfg, int round, int shard);
+
+// Streams the base table plus every shard delta of `round` into the next
+// merged table. Holds one record per input in memory.
+bool merge_shard_round(const ShardConfig &cfg, int round);
+
+// Converts a merged table into the poker_model.dat format
+bool export_table_model(const std::string &table_fn,
+                        const std::string &model_fn);
+
+// Forks num_shards worker processes per round, merges their deltas and
+// broadcasts the merged table to the next round. Returns 0 on success.
+int run_shard_training(GameState *game, const ShardConfig &cfg,
+                       const std::string &model_fn);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SUBGAME_SOLVER_H
+#define SUBGAME_SOLVER_H
+
+#include "game_state.h"
+#include "latency.h"
+#include "node.h"
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Trainer;
+
+struct ResolveConfig {
+  int budget_ms = 200; // wall-clock deadline per decision
+  int depth_limit = 4; // actions below the root before leaf evaluation
+  int num_threads = 0; // 0 = hardware concurrency
+  int leaf_rollouts = 2;
+};
+
+// Depth-limited real-time re-solving of the live subgame. Every thread runs
+// external-sampling MCCFR on its own node table. Every seat's hand, the
+// hero's included, is sampled from its range: the combos weighted by how
+// often the blueprint takes that seat's line of the public history with
+// them. Below the depth limit, leaves are valued by rollouts of the
+// blueprint average strategy. The answer is read at the hero's real info
+// set once solving is done.
+class SubgameSolver {
+private:
+  Trainer &blueprint;
+  ResolveConfig cfg;
+  LatencyRecorder latencies;
+
+  using NodeTable = std::unordered_map<std::string, Node>;
+
+  double cfr(NodeTable &nodes, GameState &state, int traverser,
+             std::vector<double> &reach, std::mt19937 &gen, int depth);
+  double leaf_value(GameState &state, int traverser, std::mt19937 &gen);
+  double rollout(GameState state, int traverser, std::mt19937 &gen);
+
+  // Deals the next street if the betting round is over; true when the hand
+  // has reached a terminal state
+  bool advance_street(GameState &state, std::mt19937 &gen);
+
+  // Hole-card combos a seat can hold with their blueprint reach weights
+  struct Range {
+    std::vector<uint8_t> cards;     // two card indices per combo
+    std::vector<double> cumulative; // running weight sums, for sampling
+  };
+  // One range per seat, empty for folded seats; uniform when the history
+  // cannot be replayed from the blinds
+  std::vector<Range> build_ranges(const GameState &root);
+
+  // Deals every seat a hand from its range, avoiding cards already out
+  void sample_hidden_cards(GameState &state, const std::vector<Range> &ranges,
+                           std::mt19937 &gen);
+
+public:
+  SubgameSolver(Trainer &blueprint, const ResolveConfig &cfg);
+
+  // Refined strategy over state.get_legal_actions() for `player_id`
+  std::vector<double> solve(const GameState &state, int player_id);
+
+  const LatencyRecorder &get_latencies() const { return latencies; }
+};
+
+#endif
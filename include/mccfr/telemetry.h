@@ -0,0 +1,127 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Cumulative training counters. Plain increments on the CFR path, so they
+// stay enabled in every run.
+struct TrainingCounters {
+  uint64_t iterations = 0;
+  uint64_t nodes_visited = 0;
+  uint64_t terminal_evals = 0;
+  uint64_t terminal_depth_sum = 0;
+  uint64_t new_infosets[4] = {0, 0, 0, 0}; // per street
+  uint64_t node_bytes = 0;
+  // Node store mappings and how many of its chunks got huge pages
+  uint64_t store_bytes = 0;
+  uint64_t store_huge_chunks = 0;
+};
+
+// Process memory counters for telemetry, each -1 where the system does not
+// provide it: page faults (getrusage), this process's dTLB load misses
+// (perf_event_open, often refused in containers) and anonymous memory
+// backed by transparent huge pages (/proc/self/smaps_rollup)
+struct MemorySample {
+  int64_t minor_faults = -1;
+  int64_t major_faults = -1;
+  int64_t dtlb_misses = -1;
+  int64_t thp_bytes = -1;
+};
+
+class MemoryProbe {
+private:
+  int tlb_fd;
+
+public:
+  explicit MemoryProbe(bool enabled);
+  ~MemoryProbe();
+
+  MemoryProbe(const MemoryProbe &) = delete;
+  MemoryProbe &operator=(const MemoryProbe &) = delete;
+
+  MemorySample sample() const;
+};
+
+// Emits TrainingCounters as JSON lines, with rates measured over the
+// interval since the previous line (the first one since construction).
+class TelemetryEmitter {
+private:
+  std::ostream *out;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point last_time;
+  TrainingCounters last;
+  MemoryProbe memory;
+  MemorySample last_memory;
+
+public:
+  // `baseline` is the counters' value when the run starts; they keep
+  // accumulating across runs of the same trainer
+  TelemetryEmitter(std::ostream *out, const TrainingCounters &baseline);
+
+  bool enabled() const { return out != nullptr; }
+
+  void emit(const TrainingCounters &counters, size_t node_count,
+            size_t bucket_count, double load_factor);
+};
+
+// Training phases whose share of wall time is accounted
+enum class TrainPhase { DEAL, COPY, INFOSET, LOOKUP, STRATEGY, TERMINAL, COUNT };
+
+// Sampled per-phase time accounting. Only one iteration in `sample_every` is
+// timed, so unsampled traversals pay a single branch per phase. Whatever the
+// sampled iterations spend outside the named phases is reported as "other".
+class PhaseAccounting {
+private:
+  std::ostream *out;
+  int report_interval;
+  int sample_every;
+  bool sampling;
+
+  uint64_t phase_ns[(int)TrainPhase::COUNT];
+  uint64_t sampled_ns;
+  uint64_t sampled_iterations;
+  std::chrono::steady_clock::time_point iteration_start;
+
+public:
+  PhaseAccounting();
+
+  // Prints a table to `out` every `report_interval` iterations
+  // (nullptr disables)
+  void configure(std::ostream *out, int report_interval, int sample_every = 16);
+  bool enabled() const { return out != nullptr; }
+  bool active() const { return sampling; }
+
+  void begin_iteration(uint64_t iteration);
+  void end_iteration(uint64_t iteration);
+  void add(TrainPhase phase, uint64_t ns) { phase_ns[(int)phase] += ns; }
+
+  void report(uint64_t iteration) const;
+};
+
+// Charges the enclosing scope to a phase while the iteration is sampled
+class PhaseTimer {
+private:
+  PhaseAccounting *acc;
+  TrainPhase phase;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  PhaseTimer(PhaseAccounting &a, TrainPhase p)
+      : acc(a.active() ? &a : nullptr), phase(p) {
+    if (acc)
+      start = std::chrono::steady_clock::now();
+  }
+  ~PhaseTimer() {
+    if (acc)
+      acc->add(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+  }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+#endif
@@ -2,28 +2,116 @@
 #define TRAINER_H
 
 #include "equity.h"
+#include "frozen_index.h"
 #include "game_state.h"
 #include "node.h"
+#include "node_arena.h"
+#include "opponent_model.h"
+#include "payoff.h"
+#include "preflop_chart.h"
+#include "telemetry.h"
+#include "../abstraction.h"
+#include "../deck.h"
+#include <csignal>
+#include <cstdint>
 #include <random>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
 using InfoSetKey = std::string;
 
+// When a training run ends: at the first limit reached (0 = no limit)
+struct TrainingBudget {
+  int64_t iterations = 0;
+  double seconds = 0;
+  // Stop once Trainer::regret_bound() has fallen to this many big blinds
+  double target_regret = 0;
+  // Seconds between regret_bound() scans, which walk every node; progress
+  // lines and the target check use the latest scan
+  double regret_check_seconds = 10;
+  // Non-zero (e.g. set by a signal handler) ends the run after the batch
+  const volatile std::sig_atomic_t *stop = nullptr;
+  // Iterations between limit checks and progress lines
+  int batch = 100;
+};
+
+class RangeTrainer;
+class SubgameSolver;
+class WarmStart;
+
 class Trainer {
+  friend class RangeTrainer;
+  friend class SubgameSolver;
+  friend class WarmStart;
+
 private:
   GameState *game;
   EquityModule em;
+  NodeArena arena;
   std::unordered_map<InfoSetKey, Node *> node_map;
 
+  bool seeded;
+  unsigned seed;
+
+  // Read-only index that replaces node_map once frozen
+  FrozenIndex frozen;
+  bool frozen_table;
+  // Whether the last model read carried a regrets section
+  bool regrets_loaded;
+
+  TrainingCounters counters;
+  std::ostream *telemetry_out;
+  int telemetry_interval;
+  PhaseAccounting phases;
+
+  Node *add_node(const InfoSetKey &key, int num_actions);
+  // Drops every node and the memory behind them
+  void clear_nodes();
+
+  // Replaces the node table with a model file and reports the abstraction it
+  // was built with
+  bool read_model(const std::string &filename, AbstractionConfig &abstraction);
+
+  SubgameSolver *resolver;
+  const OpponentModel *opponent_model;
+  PreflopChart preflop_chart;
+  WarmStart *warm_start;
+
+  // Presampled runout shared by every traversal of the current iteration:
+  // hole cards of each seat followed by the 5-card board, and each seat's
+  // final hand rank on that board
+  bool presample_runouts;
+  bool runout_active;
+  int runout_players;
+  std::vector<Card> runout_cards;
+  std::vector<int> runout_ranks;
+
+  void sample_runout(int num_players, std::mt19937 &gen);
+
   double cfr(GameState &state, int player_id, double prob_traverser,
-             std::vector<double> &reach, double prob_chance, std::mt19937 &gen,
+             const double *reach, double prob_chance, std::mt19937 &gen,
              int depth = 0);
 
-  std::vector<double> calculate_payoffs(GameState &state);
+  // settle() with the presampled runout's ranks when one is active
+  void calculate_payoffs(GameState &state, double *payoff);
 
   double get_terminal_payoff(GameState &state, int player_id);
 
+  // Expected payoff when nobody can act again before showdown: exact over
+  // every river card when at most one card is to come, otherwise an average
+  // over ALLIN_SAMPLES runouts drawn afresh on every call
+  static constexpr int ALLIN_SAMPLES = 16;
+
+  double allin_runout_payoff(GameState &state, int player_id,
+                             std::mt19937 &gen);
+
+  // Child state for the traversal, charged to the copy phase
+  GameState copy_state(const GameState &state) {
+    PhaseTimer timer(phases, TrainPhase::COPY);
+    return state;
+  }
+
   // Helper functions for card dealing
   void deal_random_hole_cards(GameState &state, std::mt19937 &gen);
   void deal_random_community_cards(GameState &state, int num_cards,
@@ -32,17 +120,114 @@ private:
 public:
   explicit Trainer(GameState *game);
 
+  // Net result of every seat of a finished hand, main and side pots
+  // included (payoff must hold MAX_SEATS entries). Live hands are ranked on
+  // the state's board unless `ranks` gives every seat's rank.
+  static void settle(const GameState &state, const int *ranks,
+                     double *payoff);
+  // Two or more players left and at most one of them can still act
+  static bool is_allin_runout(const GameState &state);
+
   ~Trainer();
 
   void train(int iterations, int num_players = 2);
+  // Runs until the budget is used up; returns the iterations done
+  int64_t train(const TrainingBudget &budget);
+
+  // Convergence proxy for runs too large for a best response: sum over info
+  // sets of the largest positive cumulative regret, per iteration of this
+  // run, in big blinds. CFR bounds exploitability by this average regret,
+  // and it shrinks roughly as 1/sqrt(iterations). Regrets loaded with the
+  // model or seeded by a warm start are in the sum but their iterations
+  // are not, so a resumed run starts out overstating the bound.
+  double regret_bound() const;
+
+  // One external-sampling CFR traversal of a freshly dealt hand
+  double traverse(int num_players, double stack, int traverser,
+                  std::mt19937 &gen);
 
   std::vector<double> get_strategy(const std::string &info_set);
 
+  // Upper bound on abstract actions at any node; row stride of batch output
+  static constexpr int MAX_ACTIONS = ActionList::MAX_ACTIONS;
+
+  // Batch lookup of average strategies. Row i of `probs` (stride
+  // MAX_ACTIONS) receives the strategy for keys[i] and num_actions[i] its
+  // length, or 0 when the key is not in the blueprint.
+  void get_strategies(std::span<const InfoSetKey> keys, std::span<double> probs,
+                      std::span<int> num_actions) const;
+  // Same, keyed by the current player's info set of each state; terminal
+  // states and states without a current player get 0 actions
+  void get_strategies(std::span<GameState> states, std::span<double> probs,
+                      std::span<int> num_actions) const;
+
   Action get_action_recommendation(GameState &state, int player_id,
                                    std::vector<double> &probabilities);
+  // Same, sampling the action with `gen` so a game can be replayed
+  Action get_action_recommendation(GameState &state, int player_id,
+                                   std::vector<double> &probabilities,
+                                   std::mt19937 &gen);
+
+  // Re-solve every recommendation in real time (nullptr = blueprint only)
+  void set_resolver(SubgameSolver *solver) { resolver = solver; }
+
+  // Shift recommendations toward exploiting the opponents profiled in the
+  // state's RiskProfiler (nullptr = play the blueprint as is)
+  void set_opponent_model(const OpponentModel *model) {
+    opponent_model = model;
+  }
+  const OpponentModel *get_opponent_model() const { return opponent_model; }
+
+  // Seed nodes created by training from another model (nullptr = start
+  // from zero)
+  void set_warm_start(WarmStart *ws) { warm_start = ws; }
+
+  // Model file section with the regret sums in node table order (u64 node
+  // count, then each node's values)
+  static constexpr uint32_t SECTION_REGRETS = 0x54524752; // "RGRT"
+
+  // Replaces the node table with a perfect-hash index of the average
+  // strategies for read-only serving. Lookups stay the same; training,
+  // saving and anything reading nodes directly need an unfrozen model.
+  void freeze();
+  bool is_frozen() const { return frozen_table; }
+  const FrozenIndex &get_frozen_index() const { return frozen; }
 
   void save_to_file(const std::string &filename);
+  // Also makes the model's abstraction the active one
   void load_from_file(const std::string &filename);
+  // False when the loaded model had no regrets (older files, or no model)
+  bool has_regrets() const { return regrets_loaded; }
+
+  // Materializes the dense preflop table from the current blueprint; it is
+  // saved with the model and answers first preflop decisions before the
+  // table. train() drops it, since it copies nodes training changes
+  void build_preflop_chart();
+  const PreflopChart &get_preflop_chart() const { return preflop_chart; }
+
+  // JSON-lines telemetry every `interval` iterations (nullptr disables)
+  void set_telemetry(std::ostream *out, int interval = 100);
+  const TrainingCounters &get_counters() const { return counters; }
+
+  // Sampled per-phase time table every `interval` iterations (nullptr
+  // disables)
+  void set_phase_report(std::ostream *out, int interval = 1000);
+
+  // Page size and NUMA placement of node memory mapped from now on
+  void set_node_store(const ArenaConfig &cfg) { arena.configure(cfg); }
+  const NodeArena &get_node_store() const { return arena; }
+
+  // Fixes the training seed (otherwise drawn from std::random_device)
+  void set_seed(unsigned s);
+
+  // Deal the whole hand once per iteration; streets reveal its board and
+  // showdowns compare precomputed ranks
+  void set_presample_runouts(bool on) { presample_runouts = on; }
+
+  // Sharded training: full regret/strategy tables and deltas against them
+  bool load_table(const std::string &filename);
+  bool save_table_delta(const std::string &base_filename,
+                        const std::string &filename);
 };
 
 #endif
\ No newline at end of file
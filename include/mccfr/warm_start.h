@@ -0,0 +1,45 @@
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include "abstraction.h"
+#include "game_state.h"
+#include "node.h"
+#include "trainer.h"
+#include <cstdint>
+#include <string>
+
+struct WarmStartConfig {
+  double weight = 1.0;        // scale of everything copied from the source
+  double mapped_weight = 0.5; // extra factor for nodes that needed mapping
+};
+
+// Seeds regrets and strategy sums of a new training run from a previously
+// trained model, possibly built with a different abstraction. Each node is
+// seeded when training first creates it: its key is recomputed under the
+// source abstraction (so changed stack/pot/bet-size buckets land in the old
+// bucket) and every new action takes the values of the nearest old action
+// of the same kind, split evenly when several new actions share one.
+class WarmStart {
+public:
+  WarmStart(GameState *game, const WarmStartConfig &cfg);
+
+  bool load(const std::string &filename);
+
+  // Fills a node just created for `player` at `state`; `info` is its key and
+  // `legal` its actions under the active abstraction. False when the source
+  // has no counterpart.
+  bool seed(Node *node, GameState &state, int player, const ActionList &legal,
+            const std::string &info);
+
+  uint64_t get_exact() const { return exact; }
+  uint64_t get_mapped() const { return mapped; }
+  uint64_t get_missed() const { return missed; }
+
+private:
+  Trainer source;
+  AbstractionConfig abstraction;
+  WarmStartConfig cfg;
+  uint64_t exact, mapped, missed;
+};
+
+#endif
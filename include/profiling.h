@@ -0,0 +1,99 @@
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Stages of a single decision that get their own latency histogram
+enum class ProfileStage {
+  DECISION,      // whole get_action_recommendation call
+  EQUITY,        // calculate_display_equity
+  INFOSET,       // compute_information_set
+  LEGAL_ACTIONS, // get_legal_actions
+  NODE_LOOKUP,   // node_map probe + strategy read
+  EXPLOIT,       // opponent-adaptive reweighting
+  COUNT
+};
+
+// Lock-free log-linear histogram of nanosecond durations. Each power of two
+// is split into SUB_BUCKETS linear buckets, so percentiles are reported with
+// at most 1/SUB_BUCKETS relative error.
+class StageHistogram {
+public:
+  static constexpr int SUB_BITS = 3;
+  static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+  static constexpr int NUM_BUCKETS = 64 * SUB_BUCKETS;
+
+  StageHistogram();
+
+  void record(uint64_t ns);
+  void reset();
+
+  uint64_t count() const { return total.load(std::memory_order_relaxed); }
+  uint64_t min() const;
+  uint64_t max() const { return max_ns.load(std::memory_order_relaxed); }
+  uint64_t percentile(double p) const; // upper bound of the bucket
+
+private:
+  std::atomic<uint64_t> buckets[NUM_BUCKETS];
+  std::atomic<uint64_t> total;
+  std::atomic<uint64_t> min_ns;
+  std::atomic<uint64_t> max_ns;
+
+  static int bucket_of(uint64_t ns);
+  static uint64_t bucket_upper(int idx);
+};
+
+// Process-wide per-stage histograms
+class StageProfiler {
+public:
+  static StageProfiler &instance();
+
+  void record(ProfileStage stage, uint64_t ns) {
+    stages[(int)stage].record(ns);
+  }
+  void reset();
+
+  // {"enabled":..,"stages":{"equity":{"count":..,"min_us":..,...},...}}
+  void write_json(std::ostream &os) const;
+
+  static const char *stage_name(ProfileStage stage);
+
+private:
+  StageHistogram stages[(int)ProfileStage::COUNT];
+};
+
+// Records the lifetime of the enclosing scope into one stage
+class ScopedStageTimer {
+public:
+  explicit ScopedStageTimer(ProfileStage s)
+      : stage(s), start(std::chrono::steady_clock::now()) {}
+  ~ScopedStageTimer() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    StageProfiler::instance().record(stage, (uint64_t)ns);
+  }
+
+  ScopedStageTimer(const ScopedStageTimer &) = delete;
+  ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+private:
+  ProfileStage stage;
+  std::chrono::steady_clock::time_point start;
+};
+
+// Timers only exist in builds configured with -DPOKERBOT_PROFILE=ON;
+// otherwise PROFILE_STAGE expands to nothing.
+#ifdef POKERBOT_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_STAGE(stage)                                                   \
+  ScopedStageTimer PROFILE_CONCAT(profile_timer_, __LINE__)(stage)
+#else
+#define PROFILE_STAGE(stage) ((void)0)
+#endif
+
+#endif
@@ -1,42 +1,139 @@
 #ifndef RISK_PROFILER_H
 #define RISK_PROFILER_H
 
-#include <map>
+#include <atomic>
+#include <cstdint>
 #include <string>
-#include <vector>
 
+// Lifetime counters of one player. Bets and calls (for AF) are postflop
+// only; VPIP, PFR and 3-bet count hands, at most once each.
 struct PlayerProfile {
   // Betting stats
-  int hands_played;
-  int hands_voluntarily_entered; // VPIP
-  int hands_raised_preflop;      // PFR
+  int hands_played = 0;
+  int hands_voluntarily_entered = 0; // VPIP
+  int hands_raised_preflop = 0;      // PFR
+  int three_bet_chances = 0;         // hands facing a single preflop raise
+  int three_bets = 0;                // ... and re-raising it
 
-  int total_bets;
-  int total_calls;
+  // Postflop aggression (AF = bets and raises / calls)
+  int total_bets = 0;
+  int total_calls = 0;
 
   // Stack tracking
-  double stack_size;
+  double stack_size = 0;
 };
 
-class RiskProfiler {
-private:
-  std::map<int, PlayerProfile> player_profiles;
+// Adds the counters of `from` to `into` (the stack is left alone)
+void merge_profile(PlayerProfile &into, const PlayerProfile &from);
+
+// Betting actions as the profiler sees them (same order as ActionType)
+enum class ProfileAction : uint8_t { FOLD, CHECK, CALL, BET, RAISE, ALLIN };
 
+// Which hands a stat is computed over
+enum class StatWindow : uint8_t {
+  LIFETIME, // every hand seen
+  DECAYED,  // completed hands, exponentially weighted toward recent ones
+  RECENT    // the last RiskProfiler::WINDOW_HANDS completed hands
+};
+
+// Rates in [0, 1] (af is a ratio); `hands` is the sample behind them
+struct ProfileStats {
+  double vpip = 0;
+  double pfr = 0;
+  double three_bet = 0;
+  double af = 0;
+  double hands = 0;
+};
+
+// Per-seat opponent statistics fed by every recorded action. Seats live in
+// a flat array, updates are O(1) without allocation and each seat has its
+// own spinlock, so tables on several threads can share one profiler.
+class RiskProfiler {
 public:
+  static constexpr int MAX_SEATS = 10;
+  static constexpr int WINDOW_HANDS = 64;
+  // Share of its weight every hand loses in the decayed stats per newer
+  // hand (about a 50-hand memory)
+  static constexpr double DECAY = 0.02;
+
   RiskProfiler();
 
   void add_player(int player_id, double initial_stack);
 
-  void update_player_profile(int player_id, const std::string &action,
-                             double bet_amount, double pot_size);
+  // `preflop_raises` is the number of raises already made this hand before
+  // a preflop action (0 unopened, 1 facing an open, ...); ignored postflop.
+  // ALLIN counts as a raise: report an all-in that only calls as CALL.
+  void update_player_profile(int player_id, ProfileAction action,
+                             double bet_amount, bool preflop,
+                             int preflop_raises);
 
   void update_stack(int player_id, double amount);
 
+  // Adds previously gathered counters (e.g. from imported hand histories)
+  // to a seat's profile
+  void merge_player_profile(int player_id, const PlayerProfile &history);
+
   PlayerProfile get_player_profile(int player_id) const;
+  ProfileStats get_stats(int player_id,
+                         StatWindow window = StatWindow::LIFETIME) const;
 
+  // Lifetime stats as text for the table display
   std::string get_formatted_stats(int player_id) const;
 
+  // Closes the current hand of every seat and starts the next one
   void reset_hand();
+
+private:
+  class SpinLock {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+  public:
+    void lock() {
+      while (flag.test_and_set(std::memory_order_acquire))
+        while (flag.test(std::memory_order_relaxed))
+          ;
+    }
+    void unlock() { flag.clear(std::memory_order_release); }
+  };
+
+  // Per-hand flags folded into the decayed and recent stats at hand end
+  enum HandFlag : uint8_t {
+    VPIP = 1,
+    PFR = 2,
+    THREE_BET_CHANCE = 4,
+    THREE_BET = 8,
+  };
+
+  struct SeatStats {
+    bool present = false;
+    bool in_hand = false;
+    PlayerProfile lifetime;
+
+    uint8_t hand_flags = 0;
+    uint8_t hand_bets = 0, hand_calls = 0; // postflop, this hand
+
+    // Decayed counts; rates divide by the decayed number of hands
+    double ema_hands = 0, ema_vpip = 0, ema_pfr = 0;
+    double ema_chances = 0, ema_three_bets = 0, ema_bets = 0, ema_calls = 0;
+
+    // Ring of the last WINDOW_HANDS hands: one bit per hand and flag, and
+    // the postflop counts with their running sums
+    uint64_t recent_flags[4] = {};
+    uint8_t recent_bets[WINDOW_HANDS] = {}, recent_calls[WINDOW_HANDS] = {};
+    int recent_bet_sum = 0, recent_call_sum = 0;
+    int recent_pos = 0, recent_hands = 0;
+  };
+
+  struct Seat {
+    mutable SpinLock lock;
+    SeatStats stats;
+  };
+
+  Seat seats[MAX_SEATS];
+
+  Seat *seat(int player_id);
+  const Seat *seat(int player_id) const;
+  static void close_hand(SeatStats &s);
 };
 
 #endif
@@ -0,0 +1,54 @@
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#include <csignal>
+#include <cstdint>
+#include <vector>
+
+class Trainer;
+
+// Headless match between blueprints. Every deal is a duplicate set: the
+// same hole cards and board are played once per seat rotation, so each
+// model holds every seat's cards equally often and the card luck cancels
+// out of its result. Actions are sampled from each model's recommendation
+// with a per-deal seed, shared by the rotations of that deal.
+struct MatchConfig {
+  int seats = 2; // a multiple of the number of models
+  int64_t deals = 100000;
+  double stack_bb = 100;
+  double sb = 1.0;
+  double bb = 2.0;
+  int workers = 1;
+  uint64_t seed = 1;
+  // Stops after the deals in progress when set (nullptr = never)
+  const volatile std::sig_atomic_t *stop = nullptr;
+};
+
+struct ModelResult {
+  int64_t hands = 0; // seats played, one per hand and seat
+  double mbb_per_hand = 0;
+  // Half width of the 95% confidence interval from the variance between
+  // duplicate sets
+  double ci95 = 0;
+  // Same, as if every hand were scored on its own; the squared ratio to
+  // ci95 is the factor of hands duplicate seating saves
+  double naive_ci95 = 0;
+};
+
+struct MatchResult {
+  int64_t deals = 0; // duplicate sets completed
+  int64_t hands = 0; // deals times seats
+  // Sets dropped because a hand could not be finished (a model had no
+  // recommendation or the hand ran too long)
+  int64_t scratched = 0;
+  double seconds = 0;
+  std::vector<ModelResult> models; // in the order given
+};
+
+// Plays the models against each other on cfg.workers threads. The models
+// are only read, through their recommendation path, and must share the
+// active abstraction. False (with a message) on an invalid setup.
+bool run_match(const std::vector<Trainer *> &models, const MatchConfig &cfg,
+               MatchResult &result);
+
+#endif
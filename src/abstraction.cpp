@@ -0,0 +1,231 @@
+#include "../include/abstraction.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+static const char *STREET_NAMES[AbstractionConfig::NUM_STREETS] = {
+    "preflop", "flop", "turn", "river"};
+
+static AbstractionConfig active = AbstractionConfig::standard();
+
+const AbstractionConfig &active_abstraction() { return active; }
+
+void set_active_abstraction(const AbstractionConfig &cfg) { active = cfg; }
+
+template <class View>
+static AbstractionConfig from_view(AbstractionPreset preset) {
+  AbstractionConfig cfg;
+  for (int st = 0; st < AbstractionConfig::NUM_STREETS; ++st) {
+    auto sizes = View::bet_sizes(st);
+    cfg.bet_sizes[st].assign(sizes.begin(), sizes.end());
+  }
+  auto stack = View::stack_bounds(), pot = View::pot_bounds(),
+       bet = View::bet_size_bounds();
+  cfg.stack_bounds.assign(stack.begin(), stack.end());
+  cfg.pot_bounds.assign(pot.begin(), pot.end());
+  cfg.bet_size_bounds.assign(bet.begin(), bet.end());
+  cfg.player_counts = {5};
+  cfg.stack_mix = {10, 25, 50, 100, 200};
+  cfg.preset = preset;
+  return cfg;
+}
+
+AbstractionConfig AbstractionConfig::standard() {
+  return from_view<StandardAbstraction>(AbstractionPreset::STANDARD);
+}
+
+AbstractionConfig AbstractionConfig::compact() {
+  return from_view<CompactAbstraction>(AbstractionPreset::COMPACT);
+}
+
+// Training sampling is not part of the comparison: it never changes keys
+bool AbstractionConfig::same_abstraction(const AbstractionConfig &o) const {
+  for (int st = 0; st < NUM_STREETS; ++st)
+    if (bet_sizes[st] != o.bet_sizes[st])
+      return false;
+  return stack_bounds == o.stack_bounds && pot_bounds == o.pot_bounds &&
+         bet_size_bounds == o.bet_size_bounds;
+}
+
+void AbstractionConfig::detect_preset() {
+  if (same_abstraction(standard()))
+    preset = AbstractionPreset::STANDARD;
+  else if (same_abstraction(compact()))
+    preset = AbstractionPreset::COMPACT;
+  else
+    preset = AbstractionPreset::CUSTOM;
+}
+
+bool AbstractionConfig::validate(const std::string &source) const {
+  auto ascending = [](const std::vector<double> &v) {
+    return std::adjacent_find(v.begin(), v.end(), std::greater_equal<>()) ==
+           v.end();
+  };
+
+  for (int st = 0; st < NUM_STREETS; ++st) {
+    const auto &sizes = bet_sizes[st];
+    if ((int)sizes.size() > MAX_BET_SIZES || !ascending(sizes) ||
+        (!sizes.empty() && sizes[0] <= 0)) {
+      std::cerr << "Cannot use " << STREET_NAMES[st] << " bet sizes in "
+                << source << ": at most " << MAX_BET_SIZES
+                << " increasing positive pot fractions\n";
+      return false;
+    }
+  }
+
+  const std::pair<const char *, const std::vector<double> *> bounds[] = {
+      {"stack_bounds", &stack_bounds},
+      {"pot_bounds", &pot_bounds},
+      {"bet_size_bounds", &bet_size_bounds}};
+  for (const auto &[name, v] : bounds) {
+    if ((int)v->size() > MAX_BOUNDS || !ascending(*v)) {
+      std::cerr << "Cannot use " << name << " in " << source << ": at most "
+                << MAX_BOUNDS << " increasing values\n";
+      return false;
+    }
+  }
+  if (num_stack_buckets() > MAX_STACK_BUCKETS) {
+    std::cerr << "Cannot use stack_bounds in " << source << ": at most "
+              << MAX_STACK_BUCKETS - 1 << " values\n";
+    return false;
+  }
+
+  if (player_counts.empty() ||
+      std::any_of(player_counts.begin(), player_counts.end(),
+                  [](int n) { return n < 2 || n > 10; })) {
+    std::cerr << "Cannot use player_counts in " << source
+              << ": need table sizes between 2 and 10\n";
+    return false;
+  }
+  if (stack_mix.empty() ||
+      std::any_of(stack_mix.begin(), stack_mix.end(),
+                  [](double s) { return s <= 0; })) {
+    std::cerr << "Cannot use stack_mix in " << source
+              << ": need positive stacks\n";
+    return false;
+  }
+  return true;
+}
+
+bool AbstractionConfig::read(std::istream &in, const std::string &source) {
+  AbstractionConfig cfg = standard();
+  std::string line;
+  int line_no = 0;
+
+  while (std::getline(in, line)) {
+    line_no++;
+    line = line.substr(0, line.find('#'));
+    size_t eq = line.find('=');
+    std::istringstream name_in(line.substr(0, eq));
+    std::string name;
+    if (!(name_in >> name))
+      continue;
+    if (eq == std::string::npos) {
+      std::cerr << "Cannot parse " << source << ":" << line_no << "\n";
+      return false;
+    }
+    std::istringstream values(line.substr(eq + 1));
+
+    if (name == "preset") {
+      std::string preset;
+      values >> preset;
+      if (preset == "standard") {
+        cfg = standard();
+      } else if (preset == "compact") {
+        cfg = compact();
+      } else {
+        std::cerr << "Cannot use preset " << preset << " in " << source
+                  << ":" << line_no << "\n";
+        return false;
+      }
+      continue;
+    }
+
+    std::vector<double> nums;
+    double x;
+    while (values >> x)
+      nums.push_back(x);
+    if (!values.eof()) {
+      std::cerr << "Cannot parse values of " << name << " in " << source
+                << ":" << line_no << "\n";
+      return false;
+    }
+
+    if (name == "bet_sizes") {
+      for (auto &sizes : cfg.bet_sizes)
+        sizes = nums;
+    } else if (name.rfind("bet_sizes.", 0) == 0) {
+      auto it = std::find(std::begin(STREET_NAMES), std::end(STREET_NAMES),
+                          name.substr(10));
+      if (it == std::end(STREET_NAMES)) {
+        std::cerr << "Cannot use street " << name.substr(10) << " in "
+                  << source << ":" << line_no << "\n";
+        return false;
+      }
+      cfg.bet_sizes[it - std::begin(STREET_NAMES)] = nums;
+    } else if (name == "stack_bounds") {
+      cfg.stack_bounds = nums;
+    } else if (name == "pot_bounds") {
+      cfg.pot_bounds = nums;
+    } else if (name == "bet_size_bounds") {
+      cfg.bet_size_bounds = nums;
+    } else if (name == "player_counts") {
+      cfg.player_counts.assign(nums.begin(), nums.end());
+    } else if (name == "stack_mix") {
+      cfg.stack_mix = nums;
+    } else {
+      std::cerr << "Cannot use setting " << name << " in " << source << ":"
+                << line_no << "\n";
+      return false;
+    }
+  }
+
+  if (!cfg.validate(source))
+    return false;
+  cfg.detect_preset();
+  *this = cfg;
+  return true;
+}
+
+bool AbstractionConfig::load(const std::string &filename) {
+  std::ifstream in(filename);
+  if (!in) {
+    std::cerr << "Cannot open abstraction " << filename << "\n";
+    return false;
+  }
+  return read(in, filename);
+}
+
+void AbstractionConfig::write(std::ostream &out) const {
+  auto list = [&](const char *name, const auto &v) {
+    out << name << " =";
+    for (auto x : v)
+      out << " " << x;
+    out << "\n";
+  };
+
+  std::ios::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision(15);
+  for (int st = 0; st < NUM_STREETS; ++st)
+    list(("bet_sizes." + std::string(STREET_NAMES[st])).c_str(),
+         bet_sizes[st]);
+  list("stack_bounds", stack_bounds);
+  list("pot_bounds", pot_bounds);
+  list("bet_size_bounds", bet_size_bounds);
+  list("player_counts", player_counts);
+  list("stack_mix", stack_mix);
+  out.precision(precision);
+  out.flags(flags);
+}
+
+void AbstractionConfig::write_section(std::ostream &out) const {
+  std::stringstream payload;
+  write(payload);
+  std::string bytes = payload.str();
+  uint64_t size = bytes.size();
+  out.write((const char *)&SECTION_TAG, sizeof(SECTION_TAG));
+  out.write((const char *)&size, sizeof(size));
+  out.write(bytes.data(), size);
+}
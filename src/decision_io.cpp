@@ -0,0 +1,472 @@
+#include "../include/decision_io.h"
+#include "../include/mccfr/trainer.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+// --- Card Parsing ---
+
+Card parse_card(const std::string &s) {
+  if (s.length() != 2)
+    return Card(Rank::TWO, Suit::CLUBS);
+
+  Rank r;
+  switch (s[0]) {
+  case '2':
+    r = Rank::TWO;
+    break;
+  case '3':
+    r = Rank::THREE;
+    break;
+  case '4':
+    r = Rank::FOUR;
+    break;
+  case '5':
+    r = Rank::FIVE;
+    break;
+  case '6':
+    r = Rank::SIX;
+    break;
+  case '7':
+    r = Rank::SEVEN;
+    break;
+  case '8':
+    r = Rank::EIGHT;
+    break;
+  case '9':
+    r = Rank::NINE;
+    break;
+  case 'T':
+    r = Rank::TEN;
+    break;
+  case 'J':
+    r = Rank::JACK;
+    break;
+  case 'Q':
+    r = Rank::QUEEN;
+    break;
+  case 'K':
+    r = Rank::KING;
+    break;
+  case 'A':
+    r = Rank::ACE;
+    break;
+  default:
+    r = Rank::TWO;
+  }
+
+  Suit suit;
+  switch (s[1]) {
+  case 'c':
+    suit = Suit::CLUBS;
+    break;
+  case 'd':
+    suit = Suit::DIAMONDS;
+    break;
+  case 'h':
+    suit = Suit::HEARTS;
+    break;
+  case 's':
+    suit = Suit::SPADES;
+    break;
+  default:
+    suit = Suit::CLUBS;
+  }
+  return Card(r, suit);
+}
+
+std::vector<Card> parse_cards(const std::string &line) {
+  std::vector<Card> cards;
+  std::stringstream ss(line);
+  std::string item;
+  while (ss >> item) {
+    cards.push_back(parse_card(item));
+  }
+  return cards;
+}
+
+
+// Concatenated cards without separators ("AhKd")
+static bool parse_card_run(std::string_view text, std::vector<Card> &cards) {
+  if (text.size() % 2 != 0)
+    return false;
+  cards.clear();
+  for (size_t i = 0; i < text.size(); i += 2) {
+    // parse_card maps unknown characters to 2c; reject them here
+    std::string_view ranks = "23456789TJQKA", suits = "cdhs";
+    if (ranks.find(text[i]) == std::string_view::npos ||
+        suits.find(text[i + 1]) == std::string_view::npos)
+      return false;
+    cards.push_back(parse_card(std::string(text.substr(i, 2))));
+  }
+  return true;
+}
+
+// --- Records ---
+
+static std::vector<std::string_view> split(std::string_view text, char sep) {
+  std::vector<std::string_view> parts;
+  size_t start = 0;
+  while (start <= text.size()) {
+    size_t end = text.find(sep, start);
+    if (end == std::string_view::npos)
+      end = text.size();
+    if (end > start)
+      parts.push_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+  return parts;
+}
+
+bool parse_decision_record(std::string_view line, DecisionRecord &rec,
+                           std::string &error) {
+  rec = DecisionRecord();
+
+  for (std::string_view token : split(line, ' ')) {
+    size_t eq = token.find('=');
+    if (eq == std::string_view::npos) {
+      error = "expected key=value, got '" + std::string(token) + "'";
+      return false;
+    }
+    std::string_view key = token.substr(0, eq);
+    std::string value(token.substr(eq + 1));
+
+    try {
+      if (key == "id") {
+        rec.id = value;
+      } else if (key == "players") {
+        rec.num_players = std::stoi(value);
+      } else if (key == "dealer") {
+        rec.dealer = std::stoi(value);
+      } else if (key == "sb") {
+        rec.sb = std::stod(value);
+      } else if (key == "bb") {
+        rec.bb = std::stod(value);
+      } else if (key == "stacks") {
+        for (std::string_view s : split(value, ','))
+          rec.stacks.push_back(std::stod(std::string(s)));
+      } else if (key == "hero") {
+        rec.hero = std::stoi(value);
+      } else if (key == "hole") {
+        if (!parse_card_run(value, rec.hole) || rec.hole.size() != 2) {
+          error = "bad hole cards '" + value + "'";
+          return false;
+        }
+      } else if (key == "board") {
+        if (!parse_card_run(value, rec.board) || rec.board.size() > 5) {
+          error = "bad board '" + value + "'";
+          return false;
+        }
+      } else if (key == "actions") {
+        for (std::string_view a : split(value, ','))
+          rec.actions.emplace_back(a);
+      } else {
+        error = "unknown field '" + std::string(key) + "'";
+        return false;
+      }
+    } catch (...) {
+      error = "bad value for '" + std::string(key) + "'";
+      return false;
+    }
+  }
+
+  if (rec.num_players < 2 || rec.num_players > 10) {
+    error = "players must be between 2 and 10";
+    return false;
+  }
+  if (rec.stacks.size() == 1)
+    rec.stacks.assign(rec.num_players, rec.stacks[0]);
+  if ((int)rec.stacks.size() != rec.num_players) {
+    error = "need one stack or one per player";
+    return false;
+  }
+  if (rec.hero < 0 || rec.hero >= rec.num_players) {
+    error = "hero seat out of range";
+    return false;
+  }
+  // Hole cards and board together hold each card at most once
+  uint64_t seen = 0;
+  for (const auto *cards : {&rec.hole, &rec.board})
+    for (const Card &c : *cards) {
+      uint64_t bit = 1ull << Deck::index(c);
+      if (seen & bit) {
+        error = "card dealt twice in hole cards or board";
+        return false;
+      }
+      seen |= bit;
+    }
+  return true;
+}
+
+Action parse_action(const GameState &state, const std::string &text) {
+  const Player &p = state.players[state.current_player_index];
+  if (text.empty())
+    return Action(-1, ActionType::FOLD);
+
+  switch (text[0]) {
+  case 'f':
+    return Action(p.id, ActionType::FOLD);
+  case 'x':
+    return Action(p.id, ActionType::CHECK);
+  case 'c': {
+    double call_amt = state.current_street_highest_bet - p.current_bet;
+    if (call_amt <= 0)
+      return Action(p.id, ActionType::CHECK);
+    return Action(p.id, ActionType::CALL, call_amt);
+  }
+  case 'a':
+    return Action(p.id, ActionType::ALLIN, p.stack);
+  case 'b':
+  case 'r': {
+    double amt;
+    try {
+      amt = std::stod(text.substr(1));
+    } catch (...) {
+      return Action(-1, ActionType::FOLD);
+    }
+    if (state.current_street_highest_bet == 0)
+      return Action(p.id, ActionType::BET, amt);
+    return Action(p.id, ActionType::RAISE, amt);
+  }
+  }
+  return Action(-1, ActionType::FOLD);
+}
+
+// Fold, check, call and all-in must be in the legal list. Bet and raise
+// sizes are free-form, so they only need the player to be able to raise
+// (all-in is legal) and a raise-to above the street's bet within the stack
+static bool is_legal(const GameState &state, const Action &action,
+                     const ActionList &legal) {
+  bool sized =
+      action.type == ActionType::BET || action.type == ActionType::RAISE;
+  const Player &p = state.players[state.current_player_index];
+  for (const Action &a : legal) {
+    if (!sized && a.type == action.type)
+      return true;
+    if (sized && a.type == ActionType::ALLIN)
+      return action.amount > state.current_street_highest_bet &&
+             action.amount - p.current_bet <= p.stack;
+  }
+  return false;
+}
+
+bool replay_decision(const DecisionRecord &rec, GameState &state,
+                     std::string &error) {
+  state.init_game_setup(rec.num_players, rec.stacks[0], rec.sb, rec.bb);
+  for (int i = 0; i < rec.num_players; ++i) {
+    state.players[i].stack = rec.stacks[i];
+    if (state.risk_profiler)
+      state.risk_profiler->update_stack(i, rec.stacks[i]);
+  }
+
+  state.start_hand(rec.dealer);
+  state.set_player_cards(rec.hero, rec.hole);
+
+  for (size_t i = 0; i < rec.actions.size(); ++i) {
+    if (state.is_terminal()) {
+      error = "hand is over before action " + std::to_string(i);
+      return false;
+    }
+
+    Action action = parse_action(state, rec.actions[i]);
+    if (action.player_id < 0) {
+      error = "bad action '" + rec.actions[i] + "'";
+      return false;
+    }
+    if (!is_legal(state, action, state.get_legal_actions())) {
+      error = "illegal action '" + rec.actions[i] + "' at action " +
+              std::to_string(i);
+      return false;
+    }
+    state.apply_action(action, false);
+
+    // Betting round closed: advance and reveal the next street
+    if (!state.is_terminal() && state.is_betting_round_over()) {
+      state.next_street();
+      if (state.is_terminal())
+        break;
+      size_t need = state.stage == Stage::FLOP   ? 3
+                    : state.stage == Stage::TURN ? 4
+                                                 : 5;
+      if (rec.board.size() < need) {
+        error = "board needs " + std::to_string(need) + " cards";
+        return false;
+      }
+      state.set_community_cards(
+          std::vector<Card>(rec.board.begin(), rec.board.begin() + need));
+    }
+  }
+
+  if (state.is_terminal() || state.get_current_player()->id != rec.hero) {
+    error = "not the hero's decision after the action history";
+    return false;
+  }
+  return true;
+}
+
+const char *action_name(ActionType type) {
+  switch (type) {
+  case ActionType::FOLD:
+    return "FOLD";
+  case ActionType::CHECK:
+    return "CHECK";
+  case ActionType::CALL:
+    return "CALL";
+  case ActionType::BET:
+    return "BET";
+  case ActionType::RAISE:
+    return "RAISE";
+  case ActionType::ALLIN:
+    return "ALLIN";
+  }
+  return "?";
+}
+
+// --- Batch Solver ---
+
+static std::string json_escape(const std::string &s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+// Solves lines[begin, end) into out[begin, end)
+static size_t solve_block(const Trainer &trainer, const BatchConfig &cfg,
+                          const std::vector<std::string> &lines,
+                          std::vector<std::string> &out, size_t begin,
+                          size_t end) {
+  EquityModule em;
+  size_t failures = 0;
+
+  std::vector<GameState> states;
+  std::vector<size_t> rows;
+  std::vector<DecisionRecord> records(end - begin);
+
+  for (size_t i = begin; i < end; ++i) {
+    DecisionRecord &rec = records[i - begin];
+    std::string error;
+    GameState state(nullptr, &em);
+    if (!parse_decision_record(lines[i], rec, error) ||
+        !replay_decision(rec, state, error)) {
+      out[i] = "{\"id\":\"" + json_escape(rec.id) + "\",\"error\":\"" +
+               json_escape(error) + "\"}";
+      failures++;
+      continue;
+    }
+    states.push_back(state);
+    rows.push_back(i);
+  }
+
+  // The preflop chart answers first; only the other states build an
+  // info-set key for the table
+  std::vector<double> probs(states.size() * Trainer::MAX_ACTIONS);
+  std::vector<int> counts(states.size());
+  std::vector<InfoSetKey> keys;
+  std::vector<size_t> key_rows;
+  for (size_t k = 0; k < states.size(); ++k) {
+    const DecisionRecord &rec = records[rows[k] - begin];
+    auto legal = states[k].get_legal_actions();
+    const PreflopChart::Entry *chart =
+        trainer.get_preflop_chart().lookup(states[k], rec.hero, legal);
+    if (chart) {
+      std::copy(chart->probs, chart->probs + chart->num_actions,
+                &probs[k * Trainer::MAX_ACTIONS]);
+      counts[k] = chart->num_actions;
+    } else {
+      keys.push_back(states[k].compute_information_set(rec.hero));
+      key_rows.push_back(k);
+    }
+  }
+
+  std::vector<double> key_probs(keys.size() * Trainer::MAX_ACTIONS);
+  std::vector<int> key_counts(keys.size());
+  trainer.get_strategies(std::span<const InfoSetKey>(keys), key_probs,
+                         key_counts);
+  for (size_t j = 0; j < keys.size(); ++j) {
+    size_t k = key_rows[j];
+    counts[k] = key_counts[j];
+    std::copy(&key_probs[j * Trainer::MAX_ACTIONS],
+              &key_probs[(j + 1) * Trainer::MAX_ACTIONS],
+              &probs[k * Trainer::MAX_ACTIONS]);
+  }
+
+  for (size_t k = 0; k < states.size(); ++k) {
+    size_t i = rows[k];
+    const DecisionRecord &rec = records[i - begin];
+    GameState &state = states[k];
+    auto legal = state.get_legal_actions();
+
+    bool from_blueprint = counts[k] == (int)legal.size();
+    double equity =
+        cfg.equity_samples > 0
+            ? em.calculate_display_equity(rec.hole, state.community_cards,
+                                          cfg.equity_samples)
+            : 0.0;
+
+    std::stringstream ss;
+    ss << std::fixed << "{\"id\":\"" << json_escape(rec.id)
+       << "\",\"actions\":[";
+    for (size_t a = 0; a < legal.size(); ++a) {
+      double p = from_blueprint ? probs[k * Trainer::MAX_ACTIONS + a]
+                                : 1.0 / legal.size();
+      ss << (a ? "," : "") << "{\"type\":\"" << action_name(legal[a].type)
+         << "\",\"amount\":" << std::setprecision(2) << legal[a].amount
+         << ",\"prob\":" << std::setprecision(4) << p << "}";
+    }
+    ss << "],\"equity\":" << std::setprecision(4) << equity
+       << ",\"source\":\"" << (from_blueprint ? "blueprint" : "uniform")
+       << "\"}";
+    out[i] = ss.str();
+  }
+  return failures;
+}
+
+size_t run_batch(Trainer &trainer, std::istream &in, std::ostream &out,
+                 const BatchConfig &cfg) {
+  int workers = std::max(1, cfg.workers);
+  size_t failures = 0;
+
+  std::vector<std::string> lines;
+  std::vector<std::string> results;
+  std::string line;
+
+  while (true) {
+    lines.clear();
+    while (lines.size() < cfg.block_size && std::getline(in, line)) {
+      if (!line.empty() && line[0] != '#')
+        lines.push_back(line);
+    }
+    if (lines.empty())
+      break;
+
+    results.assign(lines.size(), std::string());
+
+    // Contiguous slices per worker keep the output order trivial
+    size_t per = (lines.size() + workers - 1) / workers;
+    std::vector<std::thread> pool;
+    std::vector<size_t> fails(workers, 0);
+    for (int w = 1; w < workers; ++w) {
+      size_t b = std::min(lines.size(), w * per);
+      size_t e = std::min(lines.size(), b + per);
+      pool.emplace_back([&, w, b, e] {
+        fails[w] = solve_block(trainer, cfg, lines, results, b, e);
+      });
+    }
+    fails[0] = solve_block(trainer, cfg, lines, results, 0,
+                           std::min(lines.size(), per));
+    for (auto &t : pool)
+      t.join();
+
+    for (const auto &r : results)
+      out << r << "\n";
+    for (size_t f : fails)
+      failures += f;
+  }
+  out.flush();
+  return failures;
+}
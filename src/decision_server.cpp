@@ -0,0 +1,504 @@
+#include "../include/decision_server.h"
+#include "../include/mccfr/trainer.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+static const uint32_t MAX_FRAME = 64 * 1024;
+
+// --- Wire helpers ---
+
+namespace {
+
+struct Reader {
+  const uint8_t *p;
+  const uint8_t *end;
+
+  bool need(size_t n) const { return (size_t)(end - p) >= n; }
+
+  template <class T> bool get(T &v) {
+    if (!need(sizeof(T)))
+      return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+  }
+};
+
+struct Writer {
+  std::vector<uint8_t> buf;
+
+  template <class T> void put(const T &v) {
+    const uint8_t *b = (const uint8_t *)&v;
+    buf.insert(buf.end(), b, b + sizeof(T));
+  }
+};
+
+bool decode_card(uint8_t code, Card &card) {
+  if (code >= 52)
+    return false;
+  card = Card(static_cast<Rank>(code / 4), static_cast<Suit>(code % 4));
+  return true;
+}
+
+std::vector<uint8_t> error_response(uint32_t request_id, ServerStatus status,
+                                    const std::string &error) {
+  Writer w;
+  w.put(request_id);
+  w.put((uint8_t)status);
+  w.put((uint8_t)0);
+  w.put((uint8_t)0);
+  w.put((uint8_t)0);
+  w.put(0.0f);
+  w.put((uint16_t)error.size());
+  w.buf.insert(w.buf.end(), error.begin(), error.end());
+  return w.buf;
+}
+
+} // namespace
+
+bool decode_request(const uint8_t *data, size_t len, uint32_t &request_id,
+                    int &equity_samples, DecisionRecord &rec,
+                    std::string &error) {
+  Reader r{data, data + len};
+  uint8_t n, dealer, hero, n_board, n_actions, reserved;
+  uint16_t samples;
+  float sb, bb;
+
+  request_id = 0;
+  if (!r.get(request_id) || !r.get(n) || !r.get(dealer) || !r.get(hero) ||
+      !r.get(n_board) || !r.get(n_actions) || !r.get(reserved) ||
+      !r.get(samples) || !r.get(sb) || !r.get(bb)) {
+    error = "truncated header";
+    return false;
+  }
+  if (n < 2 || n > 10 || hero >= n || n_board > 5) {
+    error = "bad table description";
+    return false;
+  }
+
+  rec = DecisionRecord();
+  rec.id = std::to_string(request_id);
+  rec.num_players = n;
+  rec.dealer = dealer;
+  rec.hero = hero;
+  rec.sb = sb;
+  rec.bb = bb;
+  equity_samples = samples;
+
+  for (int i = 0; i < n; ++i) {
+    float stack;
+    if (!r.get(stack)) {
+      error = "truncated stacks";
+      return false;
+    }
+    rec.stacks.push_back(stack);
+  }
+
+  for (int i = 0; i < 2 + n_board; ++i) {
+    uint8_t code;
+    Card card(Rank::TWO, Suit::CLUBS);
+    if (!r.get(code) || !decode_card(code, card)) {
+      error = "bad card";
+      return false;
+    }
+    (i < 2 ? rec.hole : rec.board).push_back(card);
+  }
+
+  for (int i = 0; i < n_actions; ++i) {
+    uint8_t code;
+    float amount;
+    if (!r.get(code) || !r.get(amount)) {
+      error = "truncated actions";
+      return false;
+    }
+    std::string text(1, (char)code);
+    if (code == 'b' || code == 'r')
+      text += std::to_string(amount);
+    rec.actions.push_back(text);
+  }
+  return true;
+}
+
+std::vector<uint8_t> handle_request(const Trainer &trainer, EquityModule &em,
+                                    const uint8_t *data, size_t len) {
+  uint32_t request_id;
+  int equity_samples;
+  DecisionRecord rec;
+  std::string error;
+
+  if (!decode_request(data, len, request_id, equity_samples, rec, error))
+    return error_response(request_id, ServerStatus::BAD_REQUEST, error);
+
+  GameState state(nullptr, &em);
+  if (!replay_decision(rec, state, error))
+    return error_response(request_id, ServerStatus::NO_DECISION, error);
+
+  auto legal = state.get_legal_actions();
+  double probs[Trainer::MAX_ACTIONS];
+  int count;
+
+  // The preflop chart answers first, without building the info-set key
+  const PreflopChart::Entry *chart =
+      trainer.get_preflop_chart().lookup(state, rec.hero, legal);
+  if (chart) {
+    std::copy(chart->probs, chart->probs + chart->num_actions, probs);
+    count = chart->num_actions;
+  } else {
+    InfoSetKey key = state.compute_information_set(rec.hero);
+    trainer.get_strategies(std::span<const InfoSetKey>(&key, 1), probs,
+                           std::span<int>(&count, 1));
+  }
+
+  bool from_blueprint = count == (int)legal.size();
+  float equity = equity_samples > 0
+                     ? em.calculate_display_equity(
+                           rec.hole, state.community_cards, equity_samples)
+                     : 0.0f;
+
+  Writer w;
+  w.put(request_id);
+  w.put((uint8_t)ServerStatus::OK);
+  w.put((uint8_t)(from_blueprint ? 1 : 0));
+  w.put((uint8_t)legal.size());
+  w.put((uint8_t)0);
+  w.put(equity);
+  for (size_t a = 0; a < legal.size(); ++a) {
+    w.put((uint8_t)legal[a].type);
+    w.put((float)legal[a].amount);
+    w.put((float)(from_blueprint ? probs[a] : 1.0 / legal.size()));
+  }
+  return w.buf;
+}
+
+// --- Event loop ---
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void on_signal(int) { stop_requested = 1; }
+
+struct Connection {
+  int fd;
+  uint64_t generation;
+  std::vector<uint8_t> in;
+  std::vector<uint8_t> out;
+  size_t out_pos = 0;
+};
+
+struct Job {
+  int fd;
+  uint64_t generation;
+  std::vector<uint8_t> payload;
+  std::chrono::steady_clock::time_point received;
+};
+
+struct Done {
+  int fd;
+  uint64_t generation;
+  std::vector<uint8_t> payload;
+};
+
+// Jobs flow loop -> workers; results flow back through `done` + eventfd
+struct WorkQueue {
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<Job> jobs;
+  bool closing = false;
+
+  std::mutex done_mtx;
+  std::vector<Done> done;
+  int wake_fd = -1;
+};
+
+void set_nonblocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+int open_listener(const ServerConfig &cfg) {
+  int fd;
+  if (!cfg.unix_path.empty()) {
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, cfg.unix_path.c_str(),
+                 sizeof(addr.sun_path) - 1);
+    unlink(cfg.unix_path.c_str());
+    if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+      std::cerr << "Cannot bind " << cfg.unix_path << "\n";
+      if (fd >= 0)
+        close(fd);
+      return -1;
+    }
+  } else {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(cfg.tcp_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+      std::cerr << "Cannot bind 127.0.0.1:" << cfg.tcp_port << "\n";
+      if (fd >= 0)
+        close(fd);
+      return -1;
+    }
+  }
+  if (listen(fd, 128) < 0) {
+    std::cerr << "listen failed\n";
+    close(fd);
+    return -1;
+  }
+  set_nonblocking(fd);
+  return fd;
+}
+
+// Writes as much of the pending output as the socket accepts
+bool flush_connection(Connection &c) {
+  while (c.out_pos < c.out.size()) {
+    ssize_t n = send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos,
+                     MSG_NOSIGNAL);
+    if (n < 0)
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    c.out_pos += n;
+  }
+  c.out.clear();
+  c.out_pos = 0;
+  return true;
+}
+
+} // namespace
+
+int run_decision_server(const Trainer &trainer, const ServerConfig &cfg) {
+  int listen_fd = open_listener(cfg);
+  if (listen_fd < 0)
+    return 1;
+
+  int ep = epoll_create1(0);
+  WorkQueue queue;
+  queue.wake_fd = eventfd(0, EFD_NONBLOCK);
+
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.fd = listen_fd;
+  epoll_ctl(ep, EPOLL_CTL_ADD, listen_fd, &ev);
+  ev.data.fd = queue.wake_fd;
+  epoll_ctl(ep, EPOLL_CTL_ADD, queue.wake_fd, &ev);
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  // Per report interval, and over the whole run for the shutdown summary
+  LatencyRecorder latencies, total_latencies;
+  std::atomic<uint64_t> served{0};
+
+  // Worker pool
+  std::vector<std::thread> workers;
+  for (int w = 0; w < std::max(1, cfg.workers); ++w) {
+    workers.emplace_back([&] {
+      EquityModule em;
+      while (true) {
+        Job job;
+        {
+          std::unique_lock<std::mutex> lock(queue.mtx);
+          queue.cv.wait(lock,
+                        [&] { return queue.closing || !queue.jobs.empty(); });
+          if (queue.jobs.empty())
+            return;
+          job = std::move(queue.jobs.front());
+          queue.jobs.pop_front();
+        }
+
+        std::vector<uint8_t> payload = handle_request(
+            trainer, em, job.payload.data(), job.payload.size());
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - job.received)
+                        .count();
+        latencies.record(ms);
+        total_latencies.record(ms);
+        served++;
+
+        {
+          std::lock_guard<std::mutex> lock(queue.done_mtx);
+          queue.done.push_back({job.fd, job.generation, std::move(payload)});
+        }
+        uint64_t one = 1;
+        (void)!write(queue.wake_fd, &one, sizeof(one));
+      }
+    });
+  }
+
+  std::cout << "Decision server listening on "
+            << (cfg.unix_path.empty()
+                    ? "127.0.0.1:" + std::to_string(cfg.tcp_port)
+                    : cfg.unix_path)
+            << " with " << workers.size() << " workers\n";
+  std::cout.flush();
+
+  std::unordered_map<int, Connection> conns;
+  uint64_t next_generation = 1;
+  auto last_report = std::chrono::steady_clock::now();
+
+  auto close_conn = [&](int fd) {
+    epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    conns.erase(fd);
+  };
+
+  auto watch_output = [&](Connection &c) {
+    epoll_event e{};
+    e.events = c.out.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+    e.data.fd = c.fd;
+    epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &e);
+  };
+
+  epoll_event events[64];
+  while (!stop_requested) {
+    int n = epoll_wait(ep, events, 64, 1000);
+
+    for (int i = 0; i < n; ++i) {
+      int fd = events[i].data.fd;
+
+      if (fd == listen_fd) {
+        int cfd;
+        while ((cfd = accept(listen_fd, nullptr, nullptr)) >= 0) {
+          set_nonblocking(cfd);
+          epoll_event e{};
+          e.events = EPOLLIN;
+          e.data.fd = cfd;
+          epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &e);
+          conns[cfd] = Connection{cfd, next_generation++, {}, {}, 0};
+        }
+        continue;
+      }
+
+      if (fd == queue.wake_fd) {
+        uint64_t count;
+        (void)!read(queue.wake_fd, &count, sizeof(count));
+        std::vector<Done> done;
+        {
+          std::lock_guard<std::mutex> lock(queue.done_mtx);
+          done.swap(queue.done);
+        }
+        for (auto &d : done) {
+          auto it = conns.find(d.fd);
+          if (it == conns.end() || it->second.generation != d.generation)
+            continue; // client went away
+          Connection &c = it->second;
+          uint32_t len = d.payload.size();
+          const uint8_t *lb = (const uint8_t *)&len;
+          c.out.insert(c.out.end(), lb, lb + sizeof(len));
+          c.out.insert(c.out.end(), d.payload.begin(), d.payload.end());
+          if (!flush_connection(c))
+            close_conn(d.fd);
+          else
+            watch_output(c);
+        }
+        continue;
+      }
+
+      auto it = conns.find(fd);
+      if (it == conns.end())
+        continue;
+      Connection &c = it->second;
+
+      if (events[i].events & EPOLLOUT) {
+        if (!flush_connection(c)) {
+          close_conn(fd);
+          continue;
+        }
+        watch_output(c);
+      }
+
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        uint8_t buf[16 * 1024];
+        bool closed = false;
+        while (true) {
+          ssize_t r = recv(fd, buf, sizeof(buf), 0);
+          if (r > 0) {
+            c.in.insert(c.in.end(), buf, buf + r);
+            continue;
+          }
+          if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            closed = true;
+          break;
+        }
+
+        // Hand every complete frame to the workers
+        size_t pos = 0;
+        auto now = std::chrono::steady_clock::now();
+        while (c.in.size() - pos >= sizeof(uint32_t)) {
+          uint32_t len;
+          std::memcpy(&len, c.in.data() + pos, sizeof(len));
+          if (len > MAX_FRAME) {
+            closed = true;
+            break;
+          }
+          if (c.in.size() - pos - sizeof(len) < len)
+            break;
+          const uint8_t *start = c.in.data() + pos + sizeof(len);
+          {
+            std::lock_guard<std::mutex> lock(queue.mtx);
+            queue.jobs.push_back(
+                {fd, c.generation, std::vector<uint8_t>(start, start + len), now});
+          }
+          queue.cv.notify_one();
+          pos += sizeof(len) + len;
+        }
+        c.in.erase(c.in.begin(), c.in.begin() + pos);
+
+        if (closed)
+          close_conn(fd);
+      }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (cfg.report_interval_s > 0 &&
+        now - last_report >= std::chrono::seconds(cfg.report_interval_s)) {
+      if (latencies.count() > 0)
+        std::cout << "served=" << served << " latency " << latencies.summary()
+                  << "\n";
+      latencies.reset();
+      last_report = now;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue.mtx);
+    queue.closing = true;
+  }
+  queue.cv.notify_all();
+  for (auto &t : workers)
+    t.join();
+
+  for (auto &[fd, c] : conns)
+    close(fd);
+  close(listen_fd);
+  close(queue.wake_fd);
+  close(ep);
+  if (!cfg.unix_path.empty())
+    unlink(cfg.unix_path.c_str());
+
+  std::cout << "Shutting down after " << served << " requests";
+  if (total_latencies.count() > 0)
+    std::cout << ", latency " << total_latencies.summary();
+  std::cout << "\n";
+  return 0;
+}
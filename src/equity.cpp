@@ -1,5 +1,8 @@
 #include "../include/equity.h"
+#include "../include/deck.h"
+#include "../include/profiling.h"
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <iostream>
 #include <map>
@@ -8,115 +11,83 @@
 
 // --- Internal Hand Evaluation Logic ---
 
-// Helper to sort cards by rank descending
-bool compareCards(const Card &a, const Card &b) { return a.rank > b.rank; }
-
-int EquityModule::evaluate_5_cards(const std::vector<Card> &cards) {
-  if (cards.size() != 5)
-    return 0;
-
-  std::vector<Card> sorted = cards;
-  std::sort(sorted.begin(), sorted.end(), compareCards);
-
-  bool flush = true;
-  for (size_t i = 1; i < 5; ++i) {
-    if (sorted[i].suit != sorted[0].suit) {
-      flush = false;
-      break;
-    }
+// Highest straight in a rank bitmask: its top rank, or -1 for none. The
+// wheel (A-5) reports the ace as its top rank, matching the historical
+// scores of the blueprint.
+static int best_straight(unsigned ranks) {
+  const unsigned wheel = (1u << ACE) | 0xFu;
+  if ((ranks & wheel) == wheel)
+    return ACE;
+  for (int top = ACE; top >= SIX; --top) {
+    unsigned run = 0x1Fu << (top - 4);
+    if ((ranks & run) == run)
+      return top;
   }
+  return -1;
+}
 
-  bool straight = true;
-  bool royal = true;
-  std::set<Rank> royals = {Rank::TEN, 
-                            Rank::JACK,
-                            Rank::QUEEN,
-                            Rank::KING,
-                            Rank::ACE};
-  for (size_t i = 0; i < 4; ++i) {
-    if (sorted[i].rank != sorted[i + 1].rank + 1) {
-      straight = false;
-      break;
-    }
-    if (royals.find(sorted[i].rank) == royals.end()) {
-      royal = false;
-    }
-  }
-  // Wheel case: A 5 4 3 2
-  if (!straight && sorted[0].rank == Rank::ACE &&
-      sorted[1].rank == Rank::FIVE && sorted[2].rank == Rank::FOUR &&
-      sorted[3].rank == Rank::THREE && sorted[4].rank == Rank::TWO) {
-    straight = true;
-  }
+// Best category over every 5-card subset. Scores are category constants
+// (no kickers) except straight flushes, which add the top rank, and high
+// card, which is the top rank alone.
+int HandMask::score() const {
+  if (num_cards < 5)
+    return 0;
 
-  if (flush && straight) {
-    if (sorted[0].rank == Rank::ACE && sorted[1].rank == Rank::KING)
-      return 0x900000;                // Royal
-    return 0x800000 + sorted[0].rank; // Straight Flush
+  bool flush = false;
+  int best_sf = -1;
+  for (uint16_t suit : suits) {
+    if (std::popcount(suit) < 5)
+      continue;
+    flush = true;
+    if ((suit & 0x1F00) == 0x1F00)
+      return 0x900000; // Royal
+    best_sf = std::max(best_sf, best_straight(suit));
   }
+  if (best_sf >= 0)
+    return 0x800000 + best_sf; // Straight Flush
 
-  std::map<Rank, int> counts;
-  for (const auto &c : sorted)
-    counts[c.rank]++;
-
-  bool four_kind = false;
-  bool three_kind = false;
-  int pairs = 0;
-
-  for (auto const &[rank, count] : counts) {
-    if (count == 4)
-      four_kind = true;
-    if (count == 3)
-      three_kind = true;
-    if (count == 2)
+  int quads = 0, trips = 0, pairs = 0, top = -1;
+  for (int r = 0; r < 13; ++r) {
+    if (counts[r] == 0)
+      continue;
+    top = r;
+    if (counts[r] >= 4)
+      quads++;
+    else if (counts[r] == 3)
+      trips++;
+    else if (counts[r] == 2)
       pairs++;
   }
 
-  if (straight && flush && royal)
-    return 0x900000;
-  if (straight && flush) 
-    return 0x800000;
-  if (four_kind)
+  if (quads)
     return 0x700000; // Simplified score
-  if (three_kind && pairs >= 1)
+  if (trips && (trips >= 2 || pairs >= 1))
     return 0x600000;
   if (flush)
     return 0x500000;
-  if (straight)
+  if (best_straight(suits[0] | suits[1] | suits[2] | suits[3]) >= 0)
     return 0x400000;
-  if (three_kind)
+  if (trips)
     return 0x300000;
-  if (pairs == 2)
+  if (pairs >= 2)
     return 0x200000;
   if (pairs == 1)
     return 0x100000;
 
-  return sorted[0].rank;
+  return top;
 }
 
-int EquityModule::evaluate_7_cards(const std::vector<Card> &cards) {
-  if (cards.size() < 5)
+int EquityModule::evaluate_5_cards(const std::vector<Card> &cards) {
+  if (cards.size() != 5)
     return 0;
-  if (cards.size() == 5)
-    return evaluate_5_cards(cards);
-
-  int max_score = 0;
-  std::vector<int> p(cards.size());
-  std::fill(p.begin(), p.begin() + 5, 1);
-  std::fill(p.begin() + 5, p.end(), 0);
-
-  do {
-    std::vector<Card> combo;
-    for (size_t i = 0; i < cards.size(); ++i) {
-      if (p[i])
-        combo.push_back(cards[i]);
-    }
-    int score = evaluate_5_cards(combo);
-    if (score > max_score)
-      max_score = score;
-  } while (std::prev_permutation(p.begin(), p.end()));
+  return evaluate_7_cards(cards);
+}
 
-  return max_score;
+int EquityModule::evaluate_7_cards(const std::vector<Card> &cards) {
+  HandMask mask;
+  for (const auto &c : cards)
+    mask.add(c);
+  return mask.score();
 }
 
 int EquityModule::bucketize_hand(const std::vector<Card> &hero_hand,
@@ -217,60 +188,38 @@ int EquityModule::bucketize_hand(const std::vector<Card> &hero_hand,
 // Fast Monte Carlo simulation for display equity
 double
 EquityModule::calculate_display_equity(const std::vector<Card> &hero_hand,
-                                       const std::vector<Card> &board_cards) {
-  if (hero_hand.size() != 2)
+                                       const std::vector<Card> &board_cards,
+                                       int iterations) {
+  PROFILE_STAGE(ProfileStage::EQUITY);
+  if (hero_hand.size() != 2 || iterations <= 0)
     return 0.0;
 
   int wins = 0;
   int ties = 0;
-  int iterations = 1000; // Enough for display precision
-
-  // Create a full deck
-  std::vector<Card> full_deck;
-  for (int r = 0; r < 13; ++r) {
-    for (int s = 0; s < 4; ++s) {
-      full_deck.emplace_back(static_cast<Rank>(r), static_cast<Suit>(s));
-    }
-  }
 
   // Remove known cards
-  auto remove_card = [&](const Card &c) {
-    full_deck.erase(std::remove_if(full_deck.begin(), full_deck.end(),
-                                   [&](const Card &x) {
-                                     return x.rank == c.rank &&
-                                            x.suit == c.suit;
-                                   }),
-                    full_deck.end());
-  };
-
-  for (const auto &c : hero_hand)
-    remove_card(c);
-  for (const auto &c : board_cards)
-    remove_card(c);
-
-  std::mt19937 rng(std::random_device{}());
+  Deck known;
+  known.remove(hero_hand);
+  known.remove(board_cards);
 
-  for (int i = 0; i < iterations; ++i) {
-    std::vector<Card> deck = full_deck;
-    std::shuffle(deck.begin(), deck.end(), rng);
+  static thread_local FastRng rng(std::random_device{}());
 
-    // Deal opponent hand
-    std::vector<Card> opp_hand = {deck[0], deck[1]};
+  std::vector<Card> hero_full, opp_full;
+  hero_full.reserve(7);
+  opp_full.reserve(7);
 
-    // Deal remaining board
-    std::vector<Card> current_board = board_cards;
-    int board_idx = 2;
-    while (current_board.size() < 5) {
-      current_board.push_back(deck[board_idx++]);
-    }
+  for (int i = 0; i < iterations; ++i) {
+    Deck deck = known;
 
-    // Evaluate
-    std::vector<Card> hero_full = hero_hand;
-    hero_full.insert(hero_full.end(), current_board.begin(),
-                     current_board.end());
+    // Deal opponent hand, then the remaining board
+    opp_full.clear();
+    deck.draw(rng, 2, opp_full);
+    opp_full.insert(opp_full.end(), board_cards.begin(), board_cards.end());
+    deck.draw(rng, 7 - (int)opp_full.size(), opp_full);
 
-    std::vector<Card> opp_full = opp_hand;
-    opp_full.insert(opp_full.end(), current_board.begin(), current_board.end());
+    // Hero shares the completed board
+    hero_full.assign(hero_hand.begin(), hero_hand.end());
+    hero_full.insert(hero_full.end(), opp_full.begin() + 2, opp_full.end());
 
     int hero_score = evaluate_7_cards(hero_full);
     int opp_score = evaluate_7_cards(opp_full);
@@ -1,5 +1,7 @@
 #include "../include/game_state.h"
+#include "../include/profiling.h"
 #include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 
@@ -65,23 +67,26 @@ void GameState::start_hand(int input_dealer) {
     p.is_folded = false;
     p.is_all_in = false;
     p.current_bet = 0;
+    p.total_bet_size = 0;
     p.has_acted_this_street = false;
   }
 
-  // Post Blinds
+  // Post Blinds (they count toward each player's contribution to the pot)
   int sb_pos = (dealer_index + 1) % num_players;
   int bb_pos = (dealer_index + 2) % num_players;
 
   // SB
-  int sb_paid = min(small_blind_amount, players[sb_pos].stack);
+  double sb_paid = min(small_blind_amount, players[sb_pos].stack);
   players[sb_pos].stack -= sb_paid;
   players[sb_pos].current_bet = sb_paid;
+  players[sb_pos].total_bet_size = sb_paid;
   pot_size += sb_paid;
 
   // BB
-  int bb_paid = min(big_blind_amount, players[bb_pos].stack);
+  double bb_paid = min(big_blind_amount, players[bb_pos].stack);
   players[bb_pos].stack -= bb_paid;
   players[bb_pos].current_bet = bb_paid;
+  players[bb_pos].total_bet_size = bb_paid;
   pot_size += bb_paid;
   current_street_highest_bet = bb_paid;
 
@@ -134,43 +139,68 @@ void GameState::next_street() {
   }
 }
 
+// Raises made so far this hand preflop (the big blind is the bet to beat)
+static int count_preflop_raises(const std::vector<Action> &history,
+                                double big_blind) {
+  int raises = 0;
+  double highest = big_blind;
+  for (const Action &a : history) {
+    double to = a.type == ActionType::ALLIN ? a.previous_bet + a.amount
+                                            : a.amount;
+    bool raising = a.type == ActionType::BET || a.type == ActionType::RAISE ||
+                   a.type == ActionType::ALLIN;
+    if (raising && to > highest) {
+      raises++;
+      highest = to;
+    }
+  }
+  return raises;
+}
+
 bool GameState::record_action(int player_idx, Action action, bool is_train) {
   Player &p = players[player_idx];
   action.previous_bet = p.current_bet;
+
+  // Profile the action as seen before it is applied
+  bool preflop = stage == Stage::PREFLOP;
+  int preflop_raises =
+      risk_profiler && preflop
+          ? count_preflop_raises(history, big_blind_amount)
+          : 0;
+  ProfileAction profiled = (ProfileAction)action.type;
+  if (action.type == ActionType::ALLIN &&
+      p.current_bet + p.stack <= current_street_highest_bet)
+    profiled = ProfileAction::CALL;
+
   history.push_back(action);
   p.has_acted_this_street = true;
 
   if (action.type == ActionType::FOLD) {
     p.is_folded = true;
     if (risk_profiler)
-      risk_profiler->update_player_profile(p.id, "fold", 0, pot_size);
+      risk_profiler->update_player_profile(p.id, profiled, 0, preflop,
+                                           preflop_raises);
     return true;
   }
 
-  int amount_added = 0;
+  double amount_added = 0;
   if (action.type == ActionType::CALL) {
     amount_added = min(p.stack, current_street_highest_bet - p.current_bet);
-    if (risk_profiler)
-      risk_profiler->update_player_profile(p.id, "call", amount_added,
-                                           pot_size);
   } else if (action.type == ActionType::BET ||
              action.type == ActionType::RAISE) {
     amount_added = min(p.stack, action.amount - p.current_bet);
     current_street_highest_bet = action.amount;
-    if (risk_profiler)
-      risk_profiler->update_player_profile(p.id, "raise", amount_added,
-                                           pot_size);
   } else if (action.type == ActionType::ALLIN) {
     amount_added = p.stack;
     if (p.current_bet + amount_added > current_street_highest_bet) {
       current_street_highest_bet = p.current_bet + amount_added;
     }
-    if (risk_profiler)
-      risk_profiler->update_player_profile(p.id, "allin", amount_added,
-                                           pot_size);
-  } else if (action.type == ActionType::CHECK) {
-    return true;
   }
+  if (risk_profiler)
+    risk_profiler->update_player_profile(p.id, profiled, amount_added, preflop,
+                                         preflop_raises);
+  if (action.type == ActionType::CHECK)
+    return true;
 
   // if (!is_train) {
     p.stack -= amount_added;
@@ -178,7 +208,12 @@ bool GameState::record_action(int player_idx, Action action, bool is_train) {
   // }
   p.current_bet += amount_added;
   p.total_bet_size += amount_added;
-  
+
+  // Bet sizes are fractional; snap a matched bet onto the street's highest
+  // so rounding never keeps the betting round open
+  if (std::abs(p.current_bet - current_street_highest_bet) < 1e-9)
+    p.current_bet = current_street_highest_bet;
+
   if (p.stack <= 0) {
     p.is_all_in = true;
     p.stack = 0;
@@ -264,7 +299,8 @@ Player *GameState::get_player(int player_id) {
 bool GameState::is_terminal() { return type == StateType::TERMINAL || stage == Stage::SHOWDOWN; }
 
 // MCCFR Information Set
-string GameState::compute_information_set(int player_id) {
+string GameState::compute_information_set(int player_id, int num_legal) {
+  PROFILE_STAGE(ProfileStage::INFOSET);
   std::string info;
   Player *p = get_player(player_id);
   if (!p)
@@ -297,6 +333,19 @@ string GameState::compute_information_set(int player_id) {
   // }
   
   info += std::to_string(bucket) + "|";
+  info += compute_public_key(player_id, num_legal);
+  return info;
+}
+
+// Card-independent part of the information set (everything after the hand
+// bucket), shared by every hand the player could hold here
+string GameState::compute_public_key(int player_id, int num_legal,
+                                     const AbstractionConfig &abs) {
+  std::string info;
+  Player *p = get_player(player_id);
+  if (!p)
+    return "INVALID";
+
   info += std::to_string((int)stage) + "|";
 
   // ABSTRACTION: Normalize to big blinds
@@ -306,69 +355,58 @@ string GameState::compute_information_set(int player_id) {
 
   // Abstract stack size to buckets
   double stack_bb = p->stack / bb;
-  int stack_bucket = abstract_stack_size(stack_bb);
+  int stack_bucket = abstract_stack_size(stack_bb, abs);
   info += std::to_string(stack_bucket) + "|";
   // info += std::to_string(p->stack);
 
   // Abstract pot size to buckets
   double pot_bb = pot_size / bb;
-  int pot_bucket = abstract_pot_size(pot_bb);
+  int pot_bucket = abstract_pot_size(pot_bb, abs);
   info += std::to_string(pot_bucket) + "|";
   // info += std::to_string(pot_size);
 
   // Abstract action history with bet sizing
-  info += abstract_action_history() + "|";
+  info += abstract_action_history(abs) + "|";
 
   // Make info-set unique per distinct action count
-  auto legal = get_legal_actions();
-  info += std::to_string(legal.size()) + "|";
+  if (num_legal < 0)
+    num_legal = get_legal_actions(abs).size();
+  info += std::to_string(num_legal) + "|";
 
   return info;
 }
 // Abstract stack into buckets based on big blinds
-int GameState::abstract_stack_size(double stack_bb) const {
-  if (stack_bb < 10)
-    return 0; // Short stack
-  if (stack_bb < 25)
-    return 1; // Medium-short
-  if (stack_bb < 50)
-    return 2; // Medium
-  if (stack_bb < 100)
-    return 3; // Medium-deep
-  return 4;   // Deep stack
+int GameState::abstract_stack_size(double stack_bb,
+                                   const AbstractionConfig &abs) const {
+  return with_abstraction(abs, [&](auto view) {
+    return abstraction_bucket(stack_bb, view.stack_bounds());
+  });
 }
 
 // Abstract pot into buckets
-int GameState::abstract_pot_size(double pot_bb) const {
-  if (pot_bb < 5)
-    return 0; // Small pot
-  if (pot_bb < 15)
-    return 1; // Medium pot
-  if (pot_bb < 30)
-    return 2; // Large pot
-  if (pot_bb < 60)
-    return 3; // Very large pot
-  return 4;   // Huge pot
+int GameState::abstract_pot_size(double pot_bb,
+                                 const AbstractionConfig &abs) const {
+  return with_abstraction(abs, [&](auto view) {
+    return abstraction_bucket(pot_bb, view.pot_bounds());
+  });
 }
 
-// Abstract bet size relative to pot
-std::string GameState::abstract_bet_size(double bet_amount) const {
+// Abstract bet size relative to pot (standard letters: S < 1/3 pot,
+// M ~ 1/2 pot, P pot-sized, L ~ 2x pot, A all-in / overbet)
+char GameState::abstract_bet_size(double bet_amount,
+                                  const AbstractionConfig &abs) const {
   double pot = std::max(pot_size, big_blind_amount);
   double pot_fraction = bet_amount / pot;
 
-  if (pot_fraction < 0.4)
-    return "S"; // Small (< 1/3 pot)
-  if (pot_fraction < 0.75)
-    return "M"; // Medium (1/2 pot)
-  if (pot_fraction < 1.5)
-    return "P"; // Pot-sized
-  if (pot_fraction < 2.5)
-    return "L"; // Large (2x pot)
-  return "A";   // All-in / Overbet
+  int b = with_abstraction(abs, [&](auto view) {
+    return abstraction_bucket(pot_fraction, view.bet_size_bounds());
+  });
+  return AbstractionConfig::BET_LETTERS[b];
 }
 
 // Simplify action history with abstracted bet sizes and RELATIVE positions
-std::string GameState::abstract_action_history() const {
+std::string
+GameState::abstract_action_history(const AbstractionConfig &abs) const {
   std::string result;
   for (const auto &action : history) {
     // Calculate relative position: (action_player - dealer + num_players) %
@@ -392,7 +430,8 @@ std::string GameState::abstract_action_history() const {
       break;
     case ActionType::BET:
     case ActionType::RAISE:
-      result += "R" + abstract_bet_size(added);
+      result += 'R';
+      result += abstract_bet_size(added, abs);
       break;
     case ActionType::ALLIN:
       result += "A";
@@ -402,71 +441,74 @@ std::string GameState::abstract_action_history() const {
   return result.empty() ? "_" : result;
 }
 
-std::vector<Action> GameState::get_legal_actions() {
-  std::vector<Action> actions;
-  if (is_terminal())
-    return actions;
+// Legal actions under an abstraction view; instantiated once per preset so
+// the bet sizes of the common configurations are constants
+template <class View>
+static ActionList legal_actions(GameState &state, const View &view) {
+  Player *p = state.get_current_player();
+  ActionList actions(p->id);
+  double call_amt = state.current_street_highest_bet - p->current_bet;
+  int street = std::clamp((int)state.stage - (int)Stage::PREFLOP, 0, 3);
 
-  Player *p = get_current_player();
-  int call_amt = current_street_highest_bet - p->current_bet;
-
-  actions.emplace_back(p->id, ActionType::FOLD, 0);
+  actions.push_back(ActionType::FOLD, 0);
 
   if (call_amt == 0) {
-    actions.emplace_back(p->id, ActionType::CHECK, 0);
+    actions.push_back(ActionType::CHECK, 0);
 
     double pot;
 
-    if (pot_size == 0) {
-      pot = big_blind_amount;
+    if (state.pot_size == 0) {
+      pot = state.big_blind_amount;
     } else {
-      pot = pot_size;
+      pot = state.pot_size;
     }
 
-    double contribs[] = {0.33 * pot, 0.66 * pot, 1.00 * pot, 2.00 * pot};
-
-    for (double add_amount : contribs) {
+    for (double fraction : view.bet_sizes(street)) {
+      double add_amount = fraction * pot;
       if (add_amount <= p->stack) {
         double raise_to = p->current_bet + add_amount;
-        actions.emplace_back(p->id, ActionType::BET, raise_to);
+        actions.push_back(ActionType::BET, raise_to);
       }
     }
 
-    actions.emplace_back(p->id, ActionType::ALLIN, p->stack);
-
-    // if (p->stack >= pot / 2.0)
-    //  actions.emplace_back(p->id, ActionType::BET, ((double)(1/3) * pot));
-    // if (p->stack >= pot)
-    //   actions.emplace_back(p->id, ActionType::BET, pot);
-    // actions.emplace_back(p->id, ActionType::ALLIN, p->stack);
+    actions.push_back(ActionType::ALLIN, p->stack);
   } else {
     // Facing a bet
     if (p->stack < call_amt) {
-      actions.emplace_back(p->id, ActionType::CALL, p->stack);
+      actions.push_back(ActionType::CALL, p->stack);
     } else {
-      actions.emplace_back(p->id, ActionType::CALL, call_amt);
+      actions.push_back(ActionType::CALL, call_amt);
     }
 
     if (p->stack > call_amt) {
-      double pot = std::max(pot_size, big_blind_amount);
+      double pot = std::max(state.pot_size, state.big_blind_amount);
       // Use (pot + call_amt) as base for raise sizing
       double base = pot + call_amt;
-      double contribs[] = {0.33 * base, 0.66 * base, 1.00 * base, 2.00 * base};
 
-      for (double add_amount : contribs) {
-        double raise_to = current_street_highest_bet + add_amount;
+      for (double fraction : view.bet_sizes(street)) {
+        double raise_to = state.current_street_highest_bet + fraction * base;
 
-        if (raise_to > current_street_highest_bet &&
+        if (raise_to > state.current_street_highest_bet &&
             (raise_to - p->current_bet) <= p->stack) {
-          actions.emplace_back(p->id, ActionType::RAISE, raise_to);
+          actions.push_back(ActionType::RAISE, raise_to);
         }
       }
-      actions.emplace_back(p->id, ActionType::ALLIN, p->stack);
+      actions.push_back(ActionType::ALLIN, p->stack);
     }
   }
   return actions;
 }
 
+ActionList GameState::get_legal_actions(const AbstractionConfig &abs) {
+  PROFILE_STAGE(ProfileStage::LEGAL_ACTIONS);
+  if (is_terminal())
+    return ActionList();
+
+  return with_abstraction(abs, [&](const auto &view) {
+    return legal_actions(*this, view);
+  });
+}
+
 void GameState::resolve_winner() {
   // Manual resolution or simple equity check
   // For now, simple equity check if we have cards
@@ -0,0 +1,258 @@
+#include "../include/hand_history.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Seats the live profiler tracks
+constexpr int MAX_SEATS = RiskProfiler::MAX_SEATS;
+const char *STREETS[] = {"preflop", "flop", "turn", "river"};
+
+// Profiles keyed by names that point into the mapped file
+using LocalBook = std::unordered_map<std::string_view, PlayerProfile>;
+
+// Next token of `s` up to `sep` (or the end); advances `s` past it
+std::string_view next_token(std::string_view &s, char sep) {
+  size_t end = s.find(sep);
+  std::string_view token = s.substr(0, end);
+  s.remove_prefix(end == std::string_view::npos ? s.size() : end + 1);
+  return token;
+}
+
+// Counts one hand into `book`; false when the line is not a valid hand
+bool import_hand(std::string_view line, LocalBook &book, ImportStats &stats) {
+  std::string_view names[MAX_SEATS];
+  int num_seats = 0;
+  std::string_view streets[4];
+
+  while (!line.empty()) {
+    std::string_view field = next_token(line, ' ');
+    if (!field.empty() && field.back() == '\r')
+      field.remove_suffix(1);
+    size_t eq = field.find('=');
+    if (eq == std::string_view::npos)
+      continue;
+    std::string_view key = field.substr(0, eq), value = field.substr(eq + 1);
+    if (key == "seats") {
+      while (!value.empty()) {
+        if (num_seats == MAX_SEATS)
+          return false;
+        names[num_seats++] = next_token(value, ',');
+      }
+    } else {
+      for (int st = 0; st < 4; ++st)
+        if (key == STREETS[st])
+          streets[st] = value;
+    }
+  }
+  if (num_seats < 2)
+    return false;
+
+  // Same definitions as RiskProfiler: VPIP, PFR and 3-bet once per hand,
+  // AF from postflop bets and calls only
+  bool vpip[MAX_SEATS] = {}, pfr[MAX_SEATS] = {};
+  bool chance[MAX_SEATS] = {}, three_bet[MAX_SEATS] = {};
+  int bets[MAX_SEATS] = {}, calls[MAX_SEATS] = {};
+  int raises = 0; // preflop, blinds not included
+  uint64_t actions = 0;
+  for (int st = 0; st < 4; ++st) {
+    std::string_view list = streets[st];
+    while (!list.empty()) {
+      std::string_view entry = next_token(list, ',');
+      size_t colon = entry.rfind(':');
+      if (colon == std::string_view::npos || colon + 1 == entry.size())
+        return false;
+      std::string_view name = entry.substr(0, colon);
+      int seat = std::find(names, names + num_seats, name) - names;
+      if (seat == num_seats)
+        return false;
+
+      // "ac" is an all-in that only calls; the live profiler records those
+      // as calls, so they count as one here too
+      char code = entry.substr(colon + 1) == "ac" ? 'c' : entry[colon + 1];
+      bool raise;
+      switch (code) {
+      case 'b':
+      case 'r':
+      case 'a':
+        raise = true;
+        break;
+      case 'c':
+        raise = false;
+        if (st > 0)
+          calls[seat]++;
+        else
+          vpip[seat] = true;
+        break;
+      case 'f':
+      case 'x':
+        raise = false;
+        break;
+      default:
+        return false;
+      }
+      if (raise && st > 0)
+        bets[seat]++;
+      if (st == 0) {
+        if (raises == 1 && !chance[seat]) {
+          chance[seat] = true;
+          three_bet[seat] = raise;
+        }
+        if (raise) {
+          vpip[seat] = pfr[seat] = true;
+          raises++;
+        }
+      }
+      actions++;
+    }
+  }
+
+  for (int s = 0; s < num_seats; ++s) {
+    PlayerProfile &p = book[names[s]];
+    p.hands_played++;
+    p.hands_voluntarily_entered += vpip[s];
+    p.hands_raised_preflop += pfr[s];
+    p.three_bet_chances += chance[s];
+    p.three_bets += three_bet[s];
+    p.total_bets += bets[s];
+    p.total_calls += calls[s];
+  }
+  stats.hands++;
+  stats.actions += actions;
+  return true;
+}
+
+void import_chunk(std::string_view text, LocalBook &book, ImportStats &stats) {
+  while (!text.empty()) {
+    std::string_view line = next_token(text, '\n');
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos || line[start] == '#')
+      continue;
+    if (!import_hand(line.substr(start), book, stats))
+      stats.malformed++;
+  }
+}
+
+} // namespace
+
+bool import_hand_history(const std::string &fn, ProfileBook &book,
+                         const ImportConfig &cfg, ImportStats &stats) {
+  int fd = open(fn.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    std::cerr << "Cannot open hand history " << fn << "\n";
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  const char *data = nullptr;
+  if (size > 0) {
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      std::cerr << "Cannot map hand history " << fn << "\n";
+      close(fd);
+      return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    data = (const char *)map;
+  }
+  close(fd);
+
+  // Newline-aligned chunks, one per worker
+  int workers = std::max(1, cfg.workers);
+  std::string_view text(data, size);
+  std::vector<std::string_view> chunks;
+  size_t begin = 0;
+  for (int w = 0; w < workers && begin < size; ++w) {
+    size_t end = w == workers - 1 ? size : std::max(begin, size * (w + 1) / workers);
+    end = end < size ? text.find('\n', end) : size;
+    end = end == std::string_view::npos ? size : end + 1;
+    chunks.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+
+  std::vector<LocalBook> books(chunks.size());
+  std::vector<ImportStats> chunk_stats(chunks.size());
+  std::vector<std::thread> pool;
+  for (size_t c = 1; c < chunks.size(); ++c)
+    pool.emplace_back(
+        [&, c] { import_chunk(chunks[c], books[c], chunk_stats[c]); });
+  if (!chunks.empty())
+    import_chunk(chunks[0], books[0], chunk_stats[0]);
+  for (auto &t : pool)
+    t.join();
+
+  // Bulk merge: one update per (worker, player)
+  for (size_t c = 0; c < chunks.size(); ++c) {
+    for (auto &[name, profile] : books[c])
+      merge_profile(book[std::string(name)], profile);
+    stats.hands += chunk_stats[c].hands;
+    stats.actions += chunk_stats[c].actions;
+    stats.malformed += chunk_stats[c].malformed;
+  }
+  stats.bytes += size;
+
+  if (data)
+    munmap((void *)data, size);
+  return true;
+}
+
+bool load_profiles(const std::string &fn, ProfileBook &book) {
+  std::ifstream in(fn);
+  if (!in) {
+    std::cerr << "Cannot open profiles " << fn << "\n";
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream fields(line);
+    std::string name;
+    PlayerProfile p;
+    if (!(fields >> name >> p.hands_played >> p.hands_voluntarily_entered >>
+          p.hands_raised_preflop >> p.total_bets >> p.total_calls)) {
+      std::cerr << "Cannot parse profile line in " << fn << ": " << line
+                << "\n";
+      return false;
+    }
+    // 3-bet columns were added later; older files leave them at 0
+    if (!(fields >> p.three_bet_chances >> p.three_bets))
+      p.three_bet_chances = p.three_bets = 0;
+    merge_profile(book[name], p);
+  }
+  return true;
+}
+
+bool save_profiles(const std::string &fn, const ProfileBook &book) {
+  std::ofstream out(fn);
+  if (!out) {
+    std::cerr << "Cannot write profiles " << fn << "\n";
+    return false;
+  }
+  std::vector<const ProfileBook::value_type *> sorted;
+  for (auto &entry : book)
+    sorted.push_back(&entry);
+  std::sort(sorted.begin(), sorted.end(),
+            [](auto *a, auto *b) { return a->first < b->first; });
+
+  out << "# name hands vpip_hands pfr_hands bets calls 3bet_chances 3bets\n";
+  for (auto *entry : sorted) {
+    const PlayerProfile &p = entry->second;
+    out << entry->first << " " << p.hands_played << " "
+        << p.hands_voluntarily_entered << " " << p.hands_raised_preflop << " "
+        << p.total_bets << " " << p.total_calls << " " << p.three_bet_chances
+        << " " << p.three_bets << "\n";
+  }
+  return (bool)out;
+}
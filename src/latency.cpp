@@ -0,0 +1,46 @@
+#include "../include/latency.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+void LatencyRecorder::record(double ms) {
+  std::lock_guard<std::mutex> lock(mtx);
+  samples.push_back(ms);
+}
+
+void LatencyRecorder::reset() {
+  std::lock_guard<std::mutex> lock(mtx);
+  samples.clear();
+}
+
+size_t LatencyRecorder::count() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return samples.size();
+}
+
+double LatencyRecorder::percentile(double p) const {
+  std::vector<double> sorted;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    sorted = samples;
+  }
+  if (sorted.empty())
+    return 0.0;
+
+  // Nearest-rank percentile
+  size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+  rank = std::clamp<size_t>(rank, 1, sorted.size());
+  std::nth_element(sorted.begin(), sorted.begin() + rank - 1, sorted.end());
+  return sorted[rank - 1];
+}
+
+std::string LatencyRecorder::summary() const {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(2);
+  ss << "n=" << count() << " p50=" << percentile(50) << "ms"
+     << " p90=" << percentile(90) << "ms"
+     << " p99=" << percentile(99) << "ms"
+     << " max=" << percentile(100) << "ms";
+  return ss.str();
+}
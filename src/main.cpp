@@ -1,96 +1,31 @@
+#include "../include/decision_io.h"
+#include "../include/decision_server.h"
 #include "../include/game_state.h"
+#include "../include/hand_history.h"
+#include "../include/profiling.h"
+#include "../include/self_play.h"
+#include "../include/mccfr/range_trainer.h"
+#include "../include/mccfr/shard.h"
+#include "../include/mccfr/subgame_solver.h"
 #include "../include/mccfr/trainer.h"
+#include "../include/mccfr/warm_start.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <csignal>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 
 using namespace std;
 
-// --- Helper Functions ---
-
-Card parse_card(const string &s) {
-  if (s.length() != 2)
-    return Card(Rank::TWO, Suit::CLUBS);
-
-  Rank r;
-  switch (s[0]) {
-  case '2':
-    r = Rank::TWO;
-    break;
-  case '3':
-    r = Rank::THREE;
-    break;
-  case '4':
-    r = Rank::FOUR;
-    break;
-  case '5':
-    r = Rank::FIVE;
-    break;
-  case '6':
-    r = Rank::SIX;
-    break;
-  case '7':
-    r = Rank::SEVEN;
-    break;
-  case '8':
-    r = Rank::EIGHT;
-    break;
-  case '9':
-    r = Rank::NINE;
-    break;
-  case 'T':
-    r = Rank::TEN;
-    break;
-  case 'J':
-    r = Rank::JACK;
-    break;
-  case 'Q':
-    r = Rank::QUEEN;
-    break;
-  case 'K':
-    r = Rank::KING;
-    break;
-  case 'A':
-    r = Rank::ACE;
-    break;
-  default:
-    r = Rank::TWO;
-  }
-
-  Suit suit;
-  switch (s[1]) {
-  case 'c':
-    suit = Suit::CLUBS;
-    break;
-  case 'd':
-    suit = Suit::DIAMONDS;
-    break;
-  case 'h':
-    suit = Suit::HEARTS;
-    break;
-  case 's':
-    suit = Suit::SPADES;
-    break;
-  default:
-    suit = Suit::CLUBS;
-  }
-  return Card(r, suit);
-}
-
-std::vector<Card> parse_cards(const string &line) {
-  std::vector<Card> cards;
-  std::stringstream ss(line);
-  std::string item;
-  while (ss >> item) {
-    cards.push_back(parse_card(item));
-  }
-  return cards;
-}
-
 // --- Solver Mode ---
 
-void solver_mode(Trainer &trainer) {
+// `seat_history` holds imported profiles of the players by seat
+void solver_mode(Trainer &trainer,
+                 const std::vector<PlayerProfile> &seat_history) {
   RiskProfiler rp;
   EquityModule em;
   GameState game(&rp, &em);
@@ -110,6 +45,8 @@ void solver_mode(Trainer &trainer) {
   cin.ignore(10000, '\n');
 
   game.init_game_setup(num_players, stack, sb, bb);
+  for (int i = 0; i < num_players && i < (int)seat_history.size(); ++i)
+    rp.merge_player_profile(i, seat_history[i]);
 
   while (true) {
     int d_pos = -1;
@@ -188,14 +125,18 @@ void solver_mode(Trainer &trainer) {
       cout << " | Cumulative Bets: " << p->total_bet_size << "\n";
 
       if (!p->is_human) {
-        cout << "  " << rp.get_formatted_stats(p->id) << "\n";
+        cout << "  " << rp.get_formatted_stats(p->id);
+        if (const OpponentModel *model = trainer.get_opponent_model())
+          cout << " | Read: "
+               << OpponentModel::archetype_name(OpponentModel::classify(
+                      rp.get_stats(p->id, model->get_config().window)));
+        cout << "\n";
       }
 
       // MCCFR Recommendation (for Hero)
       if (p->is_human) {
         std::vector<double> probs;
         Action best = trainer.get_action_recommendation(game, p->id, probs);
-        std::vector<Action> legal = game.get_legal_actions();
 
         cout << "\n*** Solver Recommendation ***\n";
         if (!probs.empty()) {
@@ -238,29 +179,20 @@ void solver_mode(Trainer &trainer) {
       }
 
       // Input Action
-      cout << "\nActions: (f)old, (c)heck/call, (b) <amt> bet/raise, (a)llin\n";
-      cout << "Enter Action: ";
+      cout << "\nActions: (f)old, (c)heck/call, (b) <amt> bet/raise, (a)llin"
+           << " | (p)rofile\n";
       string action_str;
-      getline(cin, action_str);
+      while (true) {
+        cout << "Enter Action: ";
+        getline(cin, action_str);
+        if (action_str != "p")
+          break;
+        StageProfiler::instance().write_json(cout);
+      }
 
-      Action selected(p->id, ActionType::FOLD, 0);
-      if (action_str == "f") {
+      Action selected = parse_action(game, action_str);
+      if (selected.player_id < 0)
         selected = Action(p->id, ActionType::FOLD);
-      } else if (action_str == "c") {
-        int call_amt = game.current_street_highest_bet - p->current_bet;
-        if (call_amt == 0)
-          selected = Action(p->id, ActionType::CHECK);
-        else
-          selected = Action(p->id, ActionType::CALL, call_amt);
-      } else if (action_str == "a") {
-        selected = Action(p->id, ActionType::ALLIN, p->stack);
-      } else if (action_str[0] == 'b') {
-        double amt = stod(action_str.substr(2));
-        if (game.current_street_highest_bet == 0)
-          selected = Action(p->id, ActionType::BET, amt);
-        else
-          selected = Action(p->id, ActionType::RAISE, amt);
-      }
 
       game.apply_action(selected, false);
 
@@ -327,6 +259,77 @@ void solver_mode(Trainer &trainer) {
   }
 }
 
+// Value following `--name` anywhere on the command line, or nullptr
+const char *get_option(int argc, char *argv[], const string &name) {
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (name == argv[i])
+      return argv[i + 1];
+  }
+  return nullptr;
+}
+
+// True when `--name` appears anywhere on the command line
+bool has_flag(int argc, char *argv[], const string &name) {
+  for (int i = 1; i < argc; ++i) {
+    if (name == argv[i])
+      return true;
+  }
+  return false;
+}
+
+// Set by SIGINT/SIGTERM during training
+volatile std::sig_atomic_t stop_training = 0;
+
+void on_stop_signal(int) { stop_training = 1; }
+
+// "90", "90s", "45m", "8h", "1h30m" -> seconds (0 when unparsable)
+double parse_duration(const string &text) {
+  double total = 0;
+  const char *p = text.c_str();
+  while (*p) {
+    char *end;
+    double value = strtod(p, &end);
+    if (end == p)
+      return 0;
+    char unit = *end ? *end++ : 's';
+    if (unit == 'h')
+      total += value * 3600;
+    else if (unit == 'm')
+      total += value * 60;
+    else if (unit == 's')
+      total += value;
+    else
+      return 0;
+    p = end;
+  }
+  return total;
+}
+
+void print_node_store(const NodeArena &store) {
+  cout << "Node store: " << store.mapped_bytes() / (1 << 20) << " MiB in "
+       << store.num_chunks() << " chunks, " << store.hugetlb_chunks()
+       << " on reserved huge pages, " << store.advised_chunks()
+       << " advised for transparent huge pages, "
+       << store.interleaved_chunks() << " NUMA-interleaved";
+  if (store.fallbacks() > 0)
+    cout << " (" << store.fallbacks() << " requests refused)";
+  cout << "\n";
+}
+
+// --freeze: swap the loaded node table for the read-only perfect-hash index
+void freeze_if_requested(Trainer &trainer, int argc, char *argv[]) {
+  if (!has_flag(argc, argv, "--freeze"))
+    return;
+  trainer.freeze();
+  if (!trainer.is_frozen())
+    return;
+  const FrozenIndex &index = trainer.get_frozen_index();
+  cerr << "Frozen " << index.size() << " info sets: "
+       << index.entry_bytes() / 1024 << " KiB of entries, "
+       << (index.size() ? 8.0 * index.index_bytes() / index.size() : 0.0)
+       << " index bits per key\n";
+}
+
 // --- Main ---
 
 int main(int argc, char *argv[]) {
@@ -336,14 +339,339 @@ int main(int argc, char *argv[]) {
   GameState game(&rp, &em);
   Trainer trainer(&game);
 
-  if (argc == 3 && string(argv[1]) == "--train") {
+  // --telemetry <file|-> : JSON-lines training telemetry
+  std::ofstream telemetry_file;
+  if (const char *path = get_option(argc, argv, "--telemetry")) {
+    if (string(path) == "-") {
+      trainer.set_telemetry(&cerr);
+    } else {
+      telemetry_file.open(path);
+      trainer.set_telemetry(&telemetry_file);
+    }
+  }
+
+  // --phase-report <n> : sampled per-phase time table every n iterations
+  if (const char *n = get_option(argc, argv, "--phase-report"))
+    trainer.set_phase_report(&cout, atoi(n));
+
+  // --presample-runouts : one full deal per iteration shared by all branches
+  trainer.set_presample_runouts(has_flag(argc, argv, "--presample-runouts"));
+
+  // --abstraction <file> : bet sizes, buckets and training mix for new
+  // models (a loaded model keeps the abstraction it was trained with)
+  if (const char *fn = get_option(argc, argv, "--abstraction")) {
+    AbstractionConfig abstraction;
+    if (!abstraction.load(fn))
+      return 1;
+    set_active_abstraction(abstraction);
+  }
+
+  // --huge-pages off|transparent|explicit  --numa first-touch|interleave :
+  // page size and NUMA placement of the node store
+  ArenaConfig node_store;
+  if (const char *hp = get_option(argc, argv, "--huge-pages")) {
+    string mode = hp;
+    if (mode == "off")
+      node_store.huge_pages = HugePages::OFF;
+    else if (mode == "explicit")
+      node_store.huge_pages = HugePages::EXPLICIT;
+    else if (mode != "transparent") {
+      cerr << "Cannot use huge page mode " << mode << "\n";
+      return 1;
+    }
+  }
+  if (const char *numa = get_option(argc, argv, "--numa")) {
+    string mode = numa;
+    if (mode == "interleave")
+      node_store.numa = NumaPolicy::INTERLEAVE;
+    else if (mode != "first-touch") {
+      cerr << "Cannot use NUMA policy " << mode << "\n";
+      return 1;
+    }
+  }
+  trainer.set_node_store(node_store);
+
+  // --train <iterations> | --train-for <duration> |
+  // --train-until-exploitability <bb>   (combinable; first limit ends the run)
+  //   [--warm-start <model> [--warm-weight <w>] [--warm-mapped-weight <w>]]
+  if (argc >= 3 && (string(argv[1]) == "--train" ||
+                    string(argv[1]) == "--train-for" ||
+                    string(argv[1]) == "--train-until-exploitability")) {
+    TrainingBudget budget;
+    if (const char *n = get_option(argc, argv, "--train"))
+      budget.iterations = atoll(n);
+    if (const char *d = get_option(argc, argv, "--train-for")) {
+      budget.seconds = parse_duration(d);
+      if (budget.seconds <= 0) {
+        cerr << "Cannot parse duration " << d << "\n";
+        return 1;
+      }
+    }
+    if (const char *x = get_option(argc, argv, "--train-until-exploitability"))
+      budget.target_regret = atof(x);
+    if (budget.iterations <= 0 && budget.seconds <= 0 &&
+        budget.target_regret <= 0) {
+      cerr << "Cannot train without an iteration, time or exploitability "
+              "limit\n";
+      return 1;
+    }
+
+    std::unique_ptr<WarmStart> warm;
+    if (const char *fn = get_option(argc, argv, "--warm-start")) {
+      WarmStartConfig cfg;
+      if (const char *w = get_option(argc, argv, "--warm-weight"))
+        cfg.weight = atof(w);
+      if (const char *w = get_option(argc, argv, "--warm-mapped-weight"))
+        cfg.mapped_weight = atof(w);
+      warm = std::make_unique<WarmStart>(&game, cfg);
+      if (!warm->load(fn))
+        return 1;
+      trainer.set_warm_start(warm.get());
+    }
+
+    // SIGINT/SIGTERM: finish the current batch, then save as usual
+    budget.stop = &stop_training;
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+
+    cout << "Training";
+    if (budget.iterations > 0)
+      cout << " " << budget.iterations << " iterations";
+    if (budget.seconds > 0)
+      cout << " for up to " << budget.seconds << " s";
+    if (budget.target_regret > 0)
+      cout << " until the regret bound reaches " << budget.target_regret
+           << " bb";
+    cout << "...\n";
+    trainer.train(budget);
+    print_node_store(trainer.get_node_store());
+    if (warm) {
+      cout << "Warm start: " << warm->get_exact() << " nodes copied, "
+           << warm->get_mapped() << " mapped, " << warm->get_missed()
+           << " not in the source model\n";
+    }
+    trainer.save_to_file("poker_model.dat");
+    return 0;
+  }
+
+  // --range-train <iterations> [--range-street flop|turn|river]
+  //               [--range-stack <bb>] [--range-raises <n>]
+  if (argc >= 3 && string(argv[1]) == "--range-train") {
+    RangeConfig cfg;
+    if (const char *st = get_option(argc, argv, "--range-street")) {
+      string name = st;
+      if (name == "flop")
+        cfg.start = Stage::FLOP;
+      else if (name == "turn")
+        cfg.start = Stage::TURN;
+      else if (name != "river") {
+        cerr << "Cannot train from street " << name << "\n";
+        return 1;
+      }
+    }
+    if (const char *bb = get_option(argc, argv, "--range-stack"))
+      cfg.stack_bb = atof(bb);
+    if (const char *r = get_option(argc, argv, "--range-raises"))
+      cfg.max_raises = atoi(r);
+
     int iterations = atoi(argv[2]);
-    cout << "Training " << iterations << " iterations...\n";
-    trainer.train(iterations);
+    trainer.load_from_file("poker_model.dat");
+    // The model is saved over; without its regrets it would resume from
+    // the range updates alone
+    if (!trainer.has_regrets()) {
+      cerr << "Cannot range-train poker_model.dat: it has no regrets "
+              "section (train or resume it with --train first)\n";
+      return 1;
+    }
+    RangeTrainer range(trainer, cfg);
+    cout << "Range training " << iterations << " iterations...\n";
+    // Progress is reported here; the trainer itself stays quiet
+    uint64_t visited = 0;
+    for (int done = 0; done < iterations;) {
+      int step = std::min(100, iterations - done);
+      range.train(step);
+      done += step;
+      visited += range.get_nodes_visited();
+      cout << "Range iteration " << done << "/" << iterations
+           << " — public nodes=" << visited << "\n";
+    }
+    cout << "Visited " << visited << " public nodes\n";
     trainer.save_to_file("poker_model.dat");
     return 0;
   }
 
+  // --export-preflop : add the dense preflop chart to poker_model.dat
+  if (argc >= 2 && string(argv[1]) == "--export-preflop") {
+    trainer.load_from_file("poker_model.dat");
+    trainer.build_preflop_chart();
+    trainer.save_to_file("poker_model.dat");
+    cout << "Preflop chart (" << trainer.get_preflop_chart().num_cells()
+         << " spots) exported to poker_model.dat\n";
+    return 0;
+  }
+
+  // --print-preflop <players> <stack bucket 0-4>
+  if (argc >= 4 && string(argv[1]) == "--print-preflop") {
+    trainer.load_from_file("poker_model.dat");
+    trainer.get_preflop_chart().print(cout, atoi(argv[2]), atoi(argv[3]));
+    return 0;
+  }
+
+  // --batch [file] [--workers <n>] [--equity-samples <n>] [--freeze]
+  if (argc >= 2 && string(argv[1]) == "--batch") {
+    BatchConfig cfg;
+    if (const char *w = get_option(argc, argv, "--workers"))
+      cfg.workers = atoi(w);
+    if (const char *e = get_option(argc, argv, "--equity-samples"))
+      cfg.equity_samples = atoi(e);
+
+    trainer.load_from_file("poker_model.dat");
+    freeze_if_requested(trainer, argc, argv);
+
+    size_t failures;
+    if (argc >= 3 && string(argv[2]).rfind("--", 0) != 0) {
+      std::ifstream in(argv[2]);
+      if (!in) {
+        cerr << "Cannot open " << argv[2] << "\n";
+        return 1;
+      }
+      failures = run_batch(trainer, in, cout, cfg);
+    } else {
+      failures = run_batch(trainer, cin, cout, cfg);
+    }
+    if (failures > 0) {
+      cerr << failures << " records could not be solved\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  // --serve <unix socket> | --serve-tcp <port>  [--workers <n>] [--freeze]
+  if (argc >= 3 && (string(argv[1]) == "--serve" ||
+                    string(argv[1]) == "--serve-tcp")) {
+    ServerConfig cfg;
+    if (string(argv[1]) == "--serve")
+      cfg.unix_path = argv[2];
+    else
+      cfg.tcp_port = atoi(argv[2]);
+    if (const char *w = get_option(argc, argv, "--workers"))
+      cfg.workers = atoi(w);
+
+    trainer.load_from_file("poker_model.dat");
+    freeze_if_requested(trainer, argc, argv);
+    return run_decision_server(trainer, cfg);
+  }
+
+  // --arena <model> <model> [...] [--deals <n>] [--seats <n>] [--workers <n>]
+  // [--stack <bb>] [--seed <n>] [--freeze] : duplicate-deal match between
+  // models, reported in mbb/hand
+  if (argc >= 4 && string(argv[1]) == "--arena") {
+    std::vector<string> files;
+    for (int i = 2; i < argc && string(argv[i]).rfind("--", 0) != 0; ++i)
+      files.push_back(argv[i]);
+
+    std::vector<std::unique_ptr<Trainer>> models;
+    std::vector<Trainer *> players;
+    AbstractionConfig abstraction;
+    for (const string &fn : files) {
+      models.push_back(std::make_unique<Trainer>(&game));
+      Trainer &model = *models.back();
+      model.load_from_file(fn);
+      if (players.empty())
+        abstraction = active_abstraction();
+      else if (!active_abstraction().same_abstraction(abstraction)) {
+        cerr << "Cannot match " << fn << " against " << files[0]
+             << ": the models use different abstractions\n";
+        return 1;
+      }
+      freeze_if_requested(model, argc, argv);
+      players.push_back(&model);
+    }
+
+    MatchConfig cfg;
+    cfg.seats = players.size();
+    if (const char *s = get_option(argc, argv, "--seats"))
+      cfg.seats = atoi(s);
+    if (const char *d = get_option(argc, argv, "--deals"))
+      cfg.deals = atoll(d);
+    if (const char *w = get_option(argc, argv, "--workers"))
+      cfg.workers = atoi(w);
+    if (const char *st = get_option(argc, argv, "--stack"))
+      cfg.stack_bb = atof(st);
+    if (const char *sd = get_option(argc, argv, "--seed"))
+      cfg.seed = strtoull(sd, nullptr, 10);
+    cfg.stop = &stop_training;
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+
+    MatchResult result;
+    if (!run_match(players, cfg, result))
+      return 1;
+
+    cout << "Arena: " << result.deals << " duplicate deals, " << result.hands
+         << " hands at " << cfg.seats << " seats in " << std::fixed
+         << std::setprecision(1) << result.seconds << " s";
+    if (result.scratched > 0)
+      cout << ", " << result.scratched << " deals scratched";
+    if (stop_training)
+      cout << " (interrupted)";
+    cout << "\n";
+    for (size_t m = 0; m < files.size(); ++m) {
+      const ModelResult &r = result.models[m];
+      cout << "  " << files[m] << ": " << std::showpos << r.mbb_per_hand
+           << std::noshowpos << " mbb/hand +/- " << r.ci95 << " (95%, "
+           << r.hands << " seats played";
+      // Squared ratio of the intervals = hands saved by duplicate seating
+      if (r.ci95 > 1e-9)
+        cout << ", " << std::pow(r.naive_ci95 / r.ci95, 2)
+             << "x fewer hands than per-hand scoring";
+      cout << ")\n";
+    }
+    return 0;
+  }
+
+  // --import-history <log> [--profiles <file>] [--workers <n>] : add the
+  // players of a hand-history log to a profile file
+  if (argc >= 3 && string(argv[1]) == "--import-history") {
+    string profiles_fn = "profiles.txt";
+    if (const char *fn = get_option(argc, argv, "--profiles"))
+      profiles_fn = fn;
+    ImportConfig cfg;
+    if (const char *w = get_option(argc, argv, "--workers"))
+      cfg.workers = atoi(w);
+
+    ProfileBook book;
+    if (std::ifstream(profiles_fn) && !load_profiles(profiles_fn, book))
+      return 1;
+    ImportStats stats;
+    auto start = std::chrono::steady_clock::now();
+    if (!import_hand_history(argv[2], book, cfg, stats))
+      return 1;
+    double secs = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    if (!save_profiles(profiles_fn, book))
+      return 1;
+    cout << "Imported " << stats.hands << " hands (" << stats.actions
+         << " actions, " << stats.malformed << " malformed lines) in "
+         << std::fixed << std::setprecision(2) << secs << " s; "
+         << book.size() << " players in " << profiles_fn << "\n";
+    return 0;
+  }
+
+  // --shard-train <dir> <workers> <rounds> <iterations per round>
+  if (argc >= 6 && string(argv[1]) == "--shard-train") {
+    ShardConfig cfg;
+    cfg.dir = argv[2];
+    cfg.num_shards = atoi(argv[3]);
+    cfg.rounds = atoi(argv[4]);
+    cfg.iterations_per_round = atoi(argv[5]);
+    cfg.base_seed = std::random_device{}();
+    cfg.presample_runouts = has_flag(argc, argv, "--presample-runouts");
+    cfg.node_store = node_store;
+    return run_shard_training(&game, cfg, "poker_model.dat");
+  }
+
   cout << "1. Train MCCFR\n";
   cout << "2. Solver Mode (Manual Input)\n";
   cout << "Select: ";
@@ -360,7 +688,68 @@ int main(int argc, char *argv[]) {
   } else {
     // Try load model
     trainer.load_from_file("poker_model.dat");
-    solver_mode(trainer);
+    freeze_if_requested(trainer, argc, argv);
+
+    // --resolve-ms <ms> [--resolve-depth <d>] [--resolve-threads <n>]
+    std::unique_ptr<SubgameSolver> resolver;
+    if (const char *ms = get_option(argc, argv, "--resolve-ms")) {
+      ResolveConfig cfg;
+      cfg.budget_ms = atoi(ms);
+      if (const char *d = get_option(argc, argv, "--resolve-depth"))
+        cfg.depth_limit = atoi(d);
+      if (const char *t = get_option(argc, argv, "--resolve-threads"))
+        cfg.num_threads = atoi(t);
+      resolver = std::make_unique<SubgameSolver>(trainer, cfg);
+      trainer.set_resolver(resolver.get());
+    }
+
+    // --exploit <strength> : shift recommendations against profiled
+    // opponents (0 = blueprint, 1 = full archetype response)
+    std::unique_ptr<OpponentModel> opponent_model;
+    if (const char *x = get_option(argc, argv, "--exploit")) {
+      ExploitConfig cfg;
+      cfg.strength = std::clamp(strtod(x, nullptr), 0.0, 1.0);
+      opponent_model = std::make_unique<OpponentModel>(cfg);
+      trainer.set_opponent_model(opponent_model.get());
+    }
+
+    // --profiles <file> --seat-names <name,name,...> : start every seat
+    // with its imported hand-history profile
+    std::vector<PlayerProfile> seat_history;
+    if (const char *fn = get_option(argc, argv, "--profiles")) {
+      ProfileBook book;
+      if (!load_profiles(fn, book))
+        return 1;
+      std::stringstream names(get_option(argc, argv, "--seat-names")
+                                  ? get_option(argc, argv, "--seat-names")
+                                  : "");
+      string name;
+      while (std::getline(names, name, ',')) {
+        auto it = book.find(name);
+        seat_history.push_back(it != book.end() ? it->second
+                                                : PlayerProfile());
+      }
+    }
+
+    solver_mode(trainer, seat_history);
+
+    if (resolver) {
+      cout << "Re-solve latency: " << resolver->get_latencies().summary()
+           << "\n";
+    }
+
+    // --profile <file|->: per-stage decision timings (POKERBOT_PROFILE builds)
+    if (const char *fn = get_option(argc, argv, "--profile")) {
+      if (std::string(fn) == "-") {
+        StageProfiler::instance().write_json(cout);
+      } else {
+        std::ofstream out(fn);
+        if (!out)
+          std::cerr << "Cannot write profile " << fn << "\n";
+        else
+          StageProfiler::instance().write_json(out);
+      }
+    }
   }
 
   return 0;
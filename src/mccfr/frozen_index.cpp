@@ -0,0 +1,182 @@
+#include "../../include/mccfr/frozen_index.h"
+#include <algorithm>
+#include <cstring>
+
+// Average keys per bucket; more buckets mean cheaper pilot search but more
+// index bits per key
+static const uint64_t BUCKET_SIZE = 4;
+// Seeds tried before giving up
+static const int MAX_ATTEMPTS = 8;
+
+// splitmix64 finalizer
+static uint64_t mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t FrozenIndex::hash(std::string_view key) const {
+  uint64_t h = seed ^ (key.size() * 0x9e3779b97f4a7c15ULL);
+  size_t i = 0;
+  for (; i + 8 <= key.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, key.data() + i, 8);
+    h = mix64(h ^ word);
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, key.data() + i, key.size() - i);
+  return mix64(h ^ tail);
+}
+
+// Slot of a key hashed to `h` under `pilot`. The bucket comes from the top
+// bits of h and the fingerprint from the bottom ones; the position mixes all
+// of them with the pilot.
+uint64_t FrozenIndex::position(uint64_t h, uint16_t pilot,
+                               uint64_t table_size) {
+  return ((mix64(h + pilot * 0x9e3779b97f4a7c15ULL) >> 32) * table_size) >>
+         32;
+}
+
+const FrozenIndex::Entry &FrozenIndex::candidate(uint64_t h) const {
+  uint64_t p = position(h, pilots[bucket_of(h)], table_size);
+  if (p >= entries.size())
+    p = remap[p - entries.size()];
+  return entries[p];
+}
+
+int FrozenIndex::write_strategy(const Entry &e, double *out) {
+  for (int a = 0; a < e.num_actions; ++a)
+    out[a] = e.probs[a] / 65535.0;
+  return e.num_actions;
+}
+
+size_t FrozenIndex::index_bytes() const {
+  return pilots.size() * sizeof(uint16_t) + remap.size() * sizeof(uint32_t);
+}
+
+// Largest-remainder rounding, so the quantized strategy sums to exactly 1
+static void quantize(const double *probs, int k, uint16_t *out) {
+  double frac[FrozenIndex::SLOTS];
+  uint32_t total = 0;
+  for (int a = 0; a < k; ++a) {
+    double x = std::clamp(probs[a], 0.0, 1.0) * 65535.0;
+    out[a] = (uint16_t)x;
+    frac[a] = x - out[a];
+    total += out[a];
+  }
+  while (total < 65535 && k > 0) {
+    int best = std::max_element(frac, frac + k) - frac;
+    out[best]++;
+    frac[best] = -1.0;
+    total++;
+  }
+}
+
+bool FrozenIndex::build(const std::unordered_map<std::string, Node *> &nodes) {
+  *this = FrozenIndex();
+  size_t n = nodes.size();
+  if (n == 0)
+    return true;
+
+  std::vector<const std::string *> keys;
+  std::vector<const Node *> values;
+  keys.reserve(n);
+  values.reserve(n);
+  for (auto &[key, node] : nodes) {
+    keys.push_back(&key);
+    values.push_back(node);
+  }
+
+  // ~2% spare slots keep the last (single-key) buckets cheap to place; the
+  // positions past n are folded back onto the free slots below n
+  uint64_t buckets = (n + BUCKET_SIZE - 1) / BUCKET_SIZE;
+  uint64_t slots = n + n / 50 + 1;
+  std::vector<uint64_t> hashes(n);
+  std::vector<uint32_t> bucket_start(buckets + 1), by_bucket(n), order(buckets);
+  std::vector<uint16_t> bucket_pilots(buckets);
+  std::vector<uint8_t> taken(slots);
+
+  for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+    seed = mix64(attempt + 1);
+    num_buckets = buckets;
+    table_size = slots;
+
+    // Group keys by bucket (counting sort), largest buckets first
+    std::fill(bucket_start.begin(), bucket_start.end(), 0);
+    for (size_t i = 0; i < n; ++i) {
+      hashes[i] = hash(*keys[i]);
+      bucket_start[bucket_of(hashes[i]) + 1]++;
+    }
+    for (uint64_t b = 0; b < buckets; ++b)
+      bucket_start[b + 1] += bucket_start[b];
+    std::vector<uint32_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+      by_bucket[fill[bucket_of(hashes[i])]++] = i;
+    for (uint64_t b = 0; b < buckets; ++b)
+      order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+      return bucket_start[a + 1] - bucket_start[a] >
+             bucket_start[b + 1] - bucket_start[b];
+    });
+
+    // Smallest pilot that puts every key of the bucket on a free slot
+    std::fill(taken.begin(), taken.end(), 0);
+    bool placed_all = true;
+    for (uint32_t b : order) {
+      uint32_t begin = bucket_start[b], end = bucket_start[b + 1];
+      if (begin == end)
+        break;
+      uint64_t pos[64];
+      bool placed = false;
+      for (uint32_t pilot = 0; pilot <= UINT16_MAX && !placed; ++pilot) {
+        placed = end - begin <= 64;
+        for (uint32_t j = begin; j < end && placed; ++j) {
+          uint64_t p = position(hashes[by_bucket[j]], pilot, slots);
+          placed = !taken[p] &&
+                   std::find(pos, pos + (j - begin), p) == pos + (j - begin);
+          pos[j - begin] = p;
+        }
+        if (placed) {
+          bucket_pilots[b] = pilot;
+          for (uint32_t j = begin; j < end; ++j)
+            taken[pos[j - begin]] = 1;
+        }
+      }
+      if (!placed) {
+        placed_all = false;
+        break;
+      }
+    }
+    if (!placed_all)
+      continue;
+
+    pilots = bucket_pilots;
+    remap.assign(slots - n, 0);
+    size_t free_slot = 0;
+    for (uint64_t p = n; p < slots; ++p) {
+      if (!taken[p])
+        continue;
+      while (taken[free_slot])
+        free_slot++;
+      remap[p - n] = free_slot++;
+    }
+
+    entries.assign(n, Entry{});
+    double probs[SLOTS];
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t p = position(hashes[i], pilots[bucket_of(hashes[i])], slots);
+      Entry &e = entries[p < n ? p : remap[p - n]];
+      int k = std::min(values[i]->get_num_actions(), SLOTS);
+      values[i]->write_average_strategy(probs);
+      e.fingerprint = (uint32_t)hashes[i];
+      e.num_actions = k;
+      quantize(probs, k, e.probs);
+    }
+    return true;
+  }
+
+  *this = FrozenIndex();
+  return false;
+}
@@ -1,51 +1,89 @@
 #include "../include/mccfr/node.h"
+#include <algorithm>
 #include <numeric>
 
-Node::Node(int n) : num_actions(n) {
-  regret_sum.resize(n, 0.0);
-  strategy.resize(n, 0.0);
-  strategy_sum.resize(n, 0.0);
+Node::Node(int n)
+    : num_actions(n), owns_values(true), values(new double[2 * n]()) {}
+
+Node::Node(int n, double *storage)
+    : num_actions(n), owns_values(false), values(storage) {
+  std::fill(values, values + 2 * n, 0.0);
+}
+
+Node::~Node() {
+  if (owns_values)
+    delete[] values;
 }
 
 std::vector<double> Node::get_strategy(double realization_weight) {
+  std::vector<double> strategy(num_actions);
+  get_strategy(realization_weight, strategy.data());
+  return strategy;
+}
+
+void Node::get_strategy(double realization_weight, double *out) {
+  const double *regrets = regret_sum();
+  double *sums = strategy_sum();
   double normalizing_sum = 0;
   for (int a = 0; a < num_actions; a++) {
-    strategy[a] = regret_sum[a] > 0 ? regret_sum[a] : 0;
-    normalizing_sum += strategy[a];
+    out[a] = regrets[a] > 0 ? regrets[a] : 0;
+    normalizing_sum += out[a];
   }
 
   for (int a = 0; a < num_actions; a++) {
     if (normalizing_sum > 0)
-      strategy[a] /= normalizing_sum;
+      out[a] /= normalizing_sum;
     else
-      strategy[a] = 1.0 / num_actions;
-    strategy_sum[a] += realization_weight * strategy[a];
+      out[a] = 1.0 / num_actions;
+    sums[a] += realization_weight * out[a];
   }
-
-  return strategy;
 }
 
 std::vector<double> Node::get_average_strategy() {
   std::vector<double> avg_strategy(num_actions);
+  write_average_strategy(avg_strategy.data());
+  return avg_strategy;
+}
+
+int Node::write_average_strategy(double *out) const {
+  const double *sums = strategy_sum();
   double normalizing_sum = 0;
-  for (int a = 0; a < num_actions; a++) {
-    normalizing_sum += strategy_sum[a];
-  }
+  for (int a = 0; a < num_actions; a++)
+    normalizing_sum += sums[a];
   for (int a = 0; a < num_actions; a++) {
     if (normalizing_sum > 0)
-      avg_strategy[a] = strategy_sum[a] / normalizing_sum;
+      out[a] = sums[a] / normalizing_sum;
     else
-      avg_strategy[a] = 1.0 / num_actions;
+      out[a] = 1.0 / num_actions;
   }
-  return avg_strategy;
+  return num_actions;
+}
+
+std::vector<double> Node::get_strategy_sum() const {
+  return std::vector<double>(strategy_sum(), strategy_sum() + num_actions);
 }
 
-std::vector<double> Node::get_strategy_sum() const { return strategy_sum; }
+std::vector<double> Node::get_regret_sum() const {
+  return std::vector<double>(regret_sum(), regret_sum() + num_actions);
+}
+
+double Node::get_max_regret() const {
+  double best = 0;
+  for (int a = 0; a < num_actions; a++)
+    best = std::max(best, regret_sum()[a]);
+  return best;
+}
 
 void Node::update_regret_sum(int action, double regret) {
-  regret_sum[action] += regret;
+  regret_sum()[action] += regret;
 }
 
 void Node::set_strategy_sum(const std::vector<double> &strat_sum) {
-  strategy_sum = strat_sum;
+  std::copy_n(strat_sum.begin(),
+              std::min<size_t>(strat_sum.size(), num_actions), strategy_sum());
+}
+
+void Node::set_regret_sum(const std::vector<double> &regrets) {
+  std::copy_n(regrets.begin(), std::min<size_t>(regrets.size(), num_actions),
+              regret_sum());
 }
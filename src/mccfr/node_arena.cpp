@@ -0,0 +1,124 @@
+#include "../../include/mccfr/node_arena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const size_t HUGE_PAGE = 2 << 20;
+static const size_t ALIGN = alignof(std::max_align_t);
+
+// From <numaif.h>, which would pull in libnuma
+static const int MPOL_INTERLEAVE_MODE = 3;
+
+static size_t round_up(size_t n, size_t to) { return (n + to - 1) / to * to; }
+
+// Memory nodes listed in /sys (e.g. "0-1,3"); empty without NUMA support
+static std::vector<unsigned long> online_memory_nodes() {
+  std::vector<unsigned long> mask;
+  std::ifstream in("/sys/devices/system/node/has_memory");
+  std::string list;
+  if (!(in >> list))
+    return mask;
+  const unsigned BITS = 8 * sizeof(unsigned long);
+  const char *p = list.c_str();
+  while (*p) {
+    char *end;
+    unsigned long lo = strtoul(p, &end, 10), hi = lo;
+    if (end == p)
+      break;
+    if (*end == '-')
+      hi = strtoul(end + 1, &end, 10);
+    for (unsigned long n = lo; n <= hi; ++n) {
+      if (mask.size() <= n / BITS)
+        mask.resize(n / BITS + 1, 0);
+      mask[n / BITS] |= 1UL << (n % BITS);
+    }
+    if (*end != ',')
+      break;
+    p = end + 1;
+  }
+  return mask;
+}
+
+NodeArena::NodeArena(const ArenaConfig &cfg)
+    : config(cfg), cursor(nullptr), limit(nullptr), mapped(0), used(0),
+      hugetlb(0), advised(0), interleaved(0), failed(0) {}
+
+NodeArena::~NodeArena() { reset(); }
+
+void NodeArena::reset() {
+  for (const Chunk &c : chunks)
+    munmap(c.base, c.size);
+  chunks.clear();
+  cursor = limit = nullptr;
+  mapped = used = 0;
+  hugetlb = advised = interleaved = failed = 0;
+}
+
+void NodeArena::map_chunk(size_t min_bytes) {
+  size_t size = round_up(std::max(config.chunk_bytes, min_bytes), HUGE_PAGE);
+  void *base = MAP_FAILED;
+  size_t mapping = size;
+
+  if (config.huge_pages == HugePages::EXPLICIT) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED)
+      hugetlb++;
+    else
+      failed++;
+  }
+
+  if (base == MAP_FAILED) {
+    // Over-map by one huge page and trim, so the chunk starts 2 MB aligned
+    // and every 2 MB of it can be backed by one transparent huge page
+    mapping = size + HUGE_PAGE;
+    char *raw = (char *)mmap(nullptr, mapping, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+      throw std::bad_alloc();
+    char *aligned = (char *)round_up((uintptr_t)raw, HUGE_PAGE);
+    if (aligned > raw)
+      munmap(raw, aligned - raw);
+    munmap(aligned + size, raw + mapping - (aligned + size));
+    base = aligned;
+    mapping = size;
+
+    if (config.huge_pages != HugePages::OFF) {
+      if (madvise(base, size, MADV_HUGEPAGE) == 0)
+        advised++;
+      else
+        failed++;
+    }
+  }
+
+  // Placement has to be set before the first write faults pages in
+  if (config.numa == NumaPolicy::INTERLEAVE) {
+    std::vector<unsigned long> nodes = online_memory_nodes();
+    if (!nodes.empty() &&
+        syscall(SYS_mbind, base, mapping, MPOL_INTERLEAVE_MODE, nodes.data(),
+                nodes.size() * 8 * sizeof(unsigned long) + 1, 0) == 0)
+      interleaved++;
+    else
+      failed++;
+  }
+
+  chunks.push_back({base, mapping});
+  mapped += mapping;
+  cursor = (char *)base;
+  limit = cursor + mapping;
+}
+
+Node *NodeArena::create(int num_actions) {
+  size_t bytes = round_up(sizeof(Node) + Node::values_size(num_actions), ALIGN);
+  if (cursor == nullptr || (size_t)(limit - cursor) < bytes)
+    map_chunk(bytes);
+  char *p = cursor;
+  cursor += bytes;
+  used += bytes;
+  return new (p) Node(num_actions, (double *)(p + sizeof(Node)));
+}
@@ -0,0 +1,128 @@
+#include "../../include/mccfr/opponent_model.h"
+
+// Multipliers by archetype, spot and action class (fold, check/call, bet
+// or raise of up to the pot, larger bet or all-in) at full strength
+const double OpponentModel::RESPONSES[(int)Archetype::COUNT][NUM_SPOTS]
+                                     [NUM_CLASSES] = {
+    // BALANCED
+    {{1.0, 1.0, 1.0, 1.0}, {1.0, 1.0, 1.0, 1.0}},
+    // NIT: steal with small bets; give up against their bets
+    {{1.0, 0.75, 1.5, 1.2}, {1.6, 0.8, 0.6, 0.5}},
+    // STATION: bet bigger for value, bluff-raise less; respect their bets
+    {{1.0, 1.0, 0.8, 1.4}, {1.5, 0.9, 0.6, 0.6}},
+    // MANIAC: check to let them bet; call down lighter
+    {{1.0, 1.4, 0.8, 0.7}, {0.5, 1.5, 1.0, 1.1}},
+};
+
+OpponentModel::OpponentModel(const ExploitConfig &c) : cfg(c) {}
+
+OpponentModel::Archetype OpponentModel::classify(const ProfileStats &s) {
+  if (s.hands <= 0)
+    return Archetype::BALANCED;
+  if (s.vpip < TIGHT_VPIP)
+    return Archetype::NIT;
+  if (s.vpip > LOOSE_VPIP) {
+    if (s.af >= AGGRESSIVE_AF)
+      return Archetype::MANIAC;
+    if (s.af <= PASSIVE_AF)
+      return Archetype::STATION;
+  }
+  return Archetype::BALANCED;
+}
+
+const char *OpponentModel::archetype_name(Archetype a) {
+  switch (a) {
+  case Archetype::NIT:
+    return "nit";
+  case Archetype::STATION:
+    return "station";
+  case Archetype::MANIAC:
+    return "maniac";
+  default:
+    return "balanced";
+  }
+}
+
+ProfileStats OpponentModel::opponent_stats(const GameState &state,
+                                           int player_id, Spot spot) const {
+  const RiskProfiler &rp = *state.risk_profiler;
+  if (spot == FACING) {
+    // The bettor made the last bet or raise, which is on this street since
+    // the player faces one; an all-in short of the bet only calls it
+    for (auto it = state.history.rbegin(); it != state.history.rend(); ++it) {
+      bool raised =
+          it->type == ActionType::BET || it->type == ActionType::RAISE ||
+          (it->type == ActionType::ALLIN &&
+           it->previous_bet + it->amount >= state.current_street_highest_bet);
+      if (raised && it->player_id != player_id)
+        return rp.get_stats(it->player_id, cfg.window);
+      if (raised)
+        break;
+    }
+  }
+
+  // Pooled rates, weighted by each opponent's sample
+  ProfileStats pooled;
+  for (const Player &p : state.players) {
+    if (p.id == player_id || p.is_folded)
+      continue;
+    ProfileStats s = rp.get_stats(p.id, cfg.window);
+    pooled.vpip += s.vpip * s.hands;
+    pooled.pfr += s.pfr * s.hands;
+    pooled.three_bet += s.three_bet * s.hands;
+    pooled.af += s.af * s.hands;
+    pooled.hands += s.hands;
+  }
+  if (pooled.hands > 0) {
+    pooled.vpip /= pooled.hands;
+    pooled.pfr /= pooled.hands;
+    pooled.three_bet /= pooled.hands;
+    pooled.af /= pooled.hands;
+  }
+  return pooled;
+}
+
+OpponentModel::Archetype
+OpponentModel::adjust(const GameState &state, int player_id,
+                      const ActionList &legal,
+                      std::vector<double> &probs) const {
+  if (!state.risk_profiler || probs.size() != legal.size() ||
+      player_id < 0 || player_id >= (int)state.players.size())
+    return Archetype::BALANCED;
+
+  const Player &me = state.players[player_id];
+  double to_call = state.current_street_highest_bet - me.current_bet;
+  bool blind_only = state.stage == Stage::PREFLOP &&
+                    state.current_street_highest_bet <= state.big_blind_amount;
+  Spot spot = to_call > 0 && !blind_only ? FACING : OPEN;
+
+  ProfileStats stats = opponent_stats(state, player_id, spot);
+  Archetype archetype = classify(stats);
+  if (archetype == Archetype::BALANCED)
+    return archetype;
+
+  // Shrink toward the blueprint while the sample is small
+  double weight = cfg.strength * stats.hands / (stats.hands + cfg.prior_hands);
+  const double *response = RESPONSES[(int)archetype][spot];
+
+  double total = 0;
+  for (size_t i = 0; i < legal.size(); ++i) {
+    Action a = legal[i];
+    ActionClass c = PASSIVE;
+    if (a.type == ActionType::FOLD)
+      c = FOLD;
+    else if (a.type == ActionType::ALLIN)
+      c = BIG_BET;
+    else if (a.type == ActionType::BET || a.type == ActionType::RAISE) {
+      // Against the pot the player would face after calling
+      double raise_by = a.amount - state.current_street_highest_bet;
+      c = raise_by > state.pot_size + to_call ? BIG_BET : SMALL_BET;
+    }
+    probs[i] *= 1.0 + weight * (response[c] - 1.0);
+    total += probs[i];
+  }
+  if (total > 0)
+    for (double &p : probs)
+      p /= total;
+  return archetype;
+}
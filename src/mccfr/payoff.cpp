@@ -0,0 +1,56 @@
+#include "../../include/mccfr/payoff.h"
+#include <limits>
+
+void settle_pots(int n, const double *contrib, const bool *folded,
+                 const int *ranks, double *payoff) {
+  // Seats by ascending contribution (insertion sort, n <= MAX_SEATS)
+  int order[MAX_SEATS];
+  for (int i = 0; i < n; ++i) {
+    int j = i;
+    while (j > 0 && contrib[order[j - 1]] > contrib[i]) {
+      order[j] = order[j - 1];
+      --j;
+    }
+    order[j] = i;
+  }
+
+  // Layer k spans contribution levels (order[k-1], order[k]] and is paid by
+  // every seat from position k up. Sweeping from the top keeps the best live
+  // rank of that suffix and how many seats share it.
+  int best[MAX_SEATS];
+  double share[MAX_SEATS];
+  const int NONE = std::numeric_limits<int>::min();
+  int best_rank = NONE, winners = 0;
+
+  for (int k = n - 1; k >= 0; --k) {
+    int seat = order[k];
+    if (!folded[seat]) {
+      if (ranks[seat] > best_rank) {
+        best_rank = ranks[seat];
+        winners = 1;
+      } else if (ranks[seat] == best_rank) {
+        winners++;
+      }
+    }
+
+    double level = contrib[seat] - (k > 0 ? contrib[order[k - 1]] : 0.0);
+    best[k] = best_rank;
+    share[k] = winners > 0 ? level * (n - k) / winners : level;
+  }
+
+  // Suffix bests only decrease with k, so the layers a seat wins are the run
+  // of equal bests ending at its own position
+  double won = 0.0, refund = 0.0;
+  for (int k = 0; k < n; ++k) {
+    int seat = order[k];
+    if (best[k] == NONE)
+      refund += share[k]; // nobody live reached this level
+    else
+      won = (k > 0 && best[k] == best[k - 1]) ? won + share[k] : share[k];
+
+    double winnings = refund;
+    if (!folded[seat] && ranks[seat] == best[k])
+      winnings += won;
+    payoff[seat] = winnings - contrib[seat];
+  }
+}
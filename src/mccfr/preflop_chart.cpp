@@ -0,0 +1,359 @@
+#include "../../include/mccfr/preflop_chart.h"
+#include "../../include/mccfr/trainer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <unordered_map>
+
+static_assert(PreflopChart::SLOTS == Trainer::MAX_ACTIONS,
+              "chart rows must hold every abstract action");
+
+static const uint32_t CHART_VERSION = 2;
+// Slot of an action type past the cell's last legal action
+static const uint8_t NO_ACTION = 0xFF;
+
+// Stack (in big blinds) that lands in each abstract_stack_size bucket of
+// the standard abstraction
+static const double STACK_BB[] = {5, 15, 35, 75, 150};
+
+// Representative stacks of every bucket of the active abstraction: the
+// table above when its bounds are standard, interval midpoints otherwise
+static std::vector<double> stack_representatives() {
+  const std::vector<double> &bounds = active_abstraction().stack_bounds;
+  if (bounds == AbstractionConfig::standard().stack_bounds)
+    return std::vector<double>(std::begin(STACK_BB), std::end(STACK_BB));
+
+  std::vector<double> stacks;
+  double lower = 0.0;
+  for (double upper : bounds) {
+    stacks.push_back((lower + upper) / 2);
+    lower = upper;
+  }
+  stacks.push_back(bounds.empty() ? 100.0 : lower * 1.5);
+  return stacks;
+}
+
+// Key layout: the prior actions in the low 40 bits (8 per action: relative
+// seat, then action code), then the action count, table size, position,
+// stack bucket and pot bucket
+static const int LINE_BITS = 40;
+static uint64_t field(uint64_t key, int shift, int bits) {
+  return key >> shift & ((1ull << bits) - 1);
+}
+
+// Action codes of the abstract history: F, X, C, A, then R plus each
+// bet-size letter
+static const int CODE_RAISE = 5;
+
+static bool is_aggressive(ActionType t) {
+  return t == ActionType::BET || t == ActionType::RAISE ||
+         t == ActionType::ALLIN;
+}
+
+PreflopChart::PreflopChart() : built(false) {}
+
+bool PreflopChart::cell_key(GameState &state, int player_id, uint64_t &key) {
+  int n = state.num_players;
+  if (state.stage != Stage::PREFLOP || n < MIN_PLAYERS || n > MAX_PLAYERS)
+    return false;
+  Player *p = state.get_player(player_id);
+  if (!p)
+    return false;
+
+  // Every seat before the hero acts once, so at most n - 1 actions
+  uint64_t line = 0;
+  int count = 0;
+  for (const auto &a : state.history) {
+    if (a.player_id == player_id || count == MAX_PLAYERS - 1)
+      return false; // only the first decision of the hand is charted
+    int code = 1;
+    switch (a.type) {
+    case ActionType::FOLD:
+      code = 1;
+      break;
+    case ActionType::CHECK:
+      code = 2;
+      break;
+    case ActionType::CALL:
+      code = 3;
+      break;
+    case ActionType::ALLIN:
+      code = 4;
+      break;
+    case ActionType::BET:
+    case ActionType::RAISE:
+      code = CODE_RAISE +
+             (std::strchr(AbstractionConfig::BET_LETTERS,
+                          state.abstract_bet_size(a.amount - a.previous_bet)) -
+              AbstractionConfig::BET_LETTERS);
+      break;
+    }
+    int seat = (a.player_id - state.dealer_index + n) % n;
+    line = line << 8 | seat << 4 | code;
+    count++;
+  }
+
+  double bb = state.big_blind_amount > 0 ? state.big_blind_amount : 1.0;
+  uint64_t stack = state.abstract_stack_size(p->stack / bb);
+  uint64_t pot = state.abstract_pot_size(state.pot_size / bb);
+  uint64_t pos = (player_id - state.dealer_index + n) % n;
+  key = line | (uint64_t)count << LINE_BITS | (uint64_t)n << 43 | pos << 47 |
+        stack << 51 | pot << 55;
+  return true;
+}
+
+int PreflopChart::find_cell(uint64_t key) const {
+  auto it = std::lower_bound(keys.begin(), keys.end(), key);
+  return it != keys.end() && *it == key ? it - keys.begin() : -1;
+}
+
+const PreflopChart::Entry *PreflopChart::lookup(GameState &state,
+                                                int player_id,
+                                                const ActionList &legal) const {
+  if (!built || !state.equity_module || legal.empty() ||
+      legal.size() > (size_t)SLOTS)
+    return nullptr;
+
+  uint64_t key;
+  if (!cell_key(state, player_id, key))
+    return nullptr;
+  int cell = find_cell(key);
+  if (cell < 0)
+    return nullptr;
+
+  // Same action types in the same slots, and no more of them
+  const uint8_t *types = &cell_actions[(size_t)cell * SLOTS];
+  for (size_t a = 0; a < legal.size(); ++a)
+    if (types[a] != (uint8_t)legal[a].type)
+      return nullptr;
+  if (legal.size() < (size_t)SLOTS && types[legal.size()] != NO_ACTION)
+    return nullptr;
+
+  Player *p = state.get_player(player_id);
+  if (p->hole_cards.size() != 2)
+    return nullptr;
+  int bucket = state.equity_module->bucketize_hand(
+      p->hole_cards, state.community_cards, PRE);
+  if (bucket < 0 || bucket >= NUM_BUCKETS)
+    return nullptr;
+
+  const Entry &e = entries[(size_t)cell * NUM_BUCKETS + bucket];
+  return e.num_actions == legal.size() ? &e : nullptr;
+}
+
+void PreflopChart::build(const Trainer &trainer, EquityModule *em) {
+  keys.clear();
+  cell_actions.clear();
+  entries.clear();
+
+  // A representative hand of every bucket and the share of the 1326 combos
+  // in it, from the 169 hand classes
+  std::vector<std::vector<Card>> reps(NUM_BUCKETS);
+  double share[NUM_BUCKETS] = {};
+  for (int hi = 0; hi < 13; ++hi) {
+    for (int lo = 0; lo <= hi; ++lo) {
+      for (int suited = 0; suited < (hi == lo ? 1 : 2); ++suited) {
+        std::vector<Card> hand = {Card((Rank)hi, SPADES),
+                                  Card((Rank)lo, suited ? SPADES : HEARTS)};
+        int b = em->bucketize_hand(hand, {}, PRE);
+        if (b < 0 || b >= NUM_BUCKETS)
+          continue;
+        if (reps[b].empty())
+          reps[b] = hand;
+        share[b] += (hi == lo ? 6 : suited ? 4 : 12) / 1326.0;
+      }
+    }
+  }
+
+  std::unordered_map<uint64_t, int> seen;
+  std::vector<InfoSetKey> info(NUM_BUCKETS);
+  std::vector<double> probs(NUM_BUCKETS * SLOTS);
+  std::vector<int> counts(NUM_BUCKETS);
+
+  // Adds the cell of the current player's first decision, then follows
+  // every line from it: folds always, other actions the blueprint takes
+  // often enough, up to MAX_RAISES bets and raises
+  auto extend = [&](auto &self, GameState &s, int raises) -> void {
+    Player *hero = s.get_current_player();
+    auto legal = s.get_legal_actions();
+    uint64_t key;
+    if (legal.empty() || legal.size() > (size_t)SLOTS ||
+        !cell_key(s, hero->id, key) || seen.count(key))
+      return;
+    seen[key] = keys.size();
+
+    for (int b = 0; b < NUM_BUCKETS; ++b) {
+      if (reps[b].empty()) {
+        info[b] = "";
+        continue;
+      }
+      s.set_player_cards(hero->id, reps[b]);
+      info[b] = s.compute_information_set(hero->id, legal.size());
+    }
+    trainer.get_strategies(std::span<const InfoSetKey>(info), probs, counts);
+
+    keys.push_back(key);
+    for (int a = 0; a < SLOTS; ++a)
+      cell_actions.push_back(a < (int)legal.size() ? (uint8_t)legal[a].type
+                                                   : NO_ACTION);
+    double freq[SLOTS] = {};
+    for (int b = 0; b < NUM_BUCKETS; ++b) {
+      Entry e{};
+      bool found = !reps[b].empty() && counts[b] == (int)legal.size();
+      e.num_actions = found ? legal.size() : 0;
+      for (size_t a = 0; a < legal.size(); ++a) {
+        double p = found ? probs[b * SLOTS + a] : 1.0 / legal.size();
+        if (found)
+          e.probs[a] = p;
+        freq[a] += share[b] * p;
+      }
+      entries.push_back(e);
+    }
+
+    for (size_t a = 0; a < legal.size(); ++a) {
+      bool raise = is_aggressive(legal[a].type);
+      if ((legal[a].type != ActionType::FOLD && freq[a] < MIN_LINE_FREQ) ||
+          (raise && raises >= MAX_RAISES))
+        continue;
+      GameState next = s;
+      next.apply_action(legal[a], true);
+      if (!next.is_terminal() && !next.is_betting_round_over())
+        self(self, next, raises + raise);
+    }
+  };
+
+  for (int n = MIN_PLAYERS; n <= MAX_PLAYERS; ++n) {
+    for (double stack_bb : stack_representatives()) {
+      GameState s(nullptr, em);
+      s.init_game_setup(n, stack_bb * 2.0, 1.0, 2.0);
+      s.start_hand(0);
+      extend(extend, s, 0);
+    }
+  }
+
+  // Sort the cells by key for the binary search
+  std::vector<int> order(keys.size());
+  for (size_t c = 0; c < order.size(); ++c)
+    order[c] = c;
+  std::sort(order.begin(), order.end(),
+            [&](int a, int b) { return keys[a] < keys[b]; });
+  std::vector<uint64_t> sorted_keys;
+  std::vector<uint8_t> sorted_actions;
+  std::vector<Entry> sorted_entries;
+  for (int c : order) {
+    sorted_keys.push_back(keys[c]);
+    sorted_actions.insert(sorted_actions.end(),
+                          cell_actions.begin() + (size_t)c * SLOTS,
+                          cell_actions.begin() + (size_t)(c + 1) * SLOTS);
+    sorted_entries.insert(sorted_entries.end(),
+                          entries.begin() + (size_t)c * NUM_BUCKETS,
+                          entries.begin() + (size_t)(c + 1) * NUM_BUCKETS);
+  }
+  keys.swap(sorted_keys);
+  cell_actions.swap(sorted_actions);
+  entries.swap(sorted_entries);
+  built = true;
+}
+
+void PreflopChart::print(std::ostream &os, int n, int stack) const {
+  if (!built || n < MIN_PLAYERS || n > MAX_PLAYERS || stack < 0) {
+    os << "No preflop chart for " << n << " players, stack bucket " << stack
+       << "\n";
+    return;
+  }
+
+  EquityModule em;
+  const char *ranks = "23456789TJQKA";
+  const char *codes = " FXCA";
+  for (size_t cell = 0; cell < keys.size(); ++cell) {
+    uint64_t key = keys[cell];
+    int count = field(key, LINE_BITS, 3);
+    if ((int)field(key, 43, 4) != n || (int)field(key, 51, 4) != stack)
+      continue;
+
+    // Unopened and single-raise spots only: prior folds and at most one
+    // other action
+    std::string line;
+    int acted = 0;
+    for (int k = count - 1; k >= 0; --k) {
+      int seat = field(key, 8 * k + 4, 4), code = field(key, 8 * k, 4);
+      line += std::to_string(seat);
+      if (code >= CODE_RAISE) {
+        line += 'R';
+        line += AbstractionConfig::BET_LETTERS[code - CODE_RAISE];
+      } else {
+        line += codes[code];
+      }
+      line += ' ';
+      acted += code != 1;
+    }
+    if (acted > 1)
+      continue;
+
+    os << "\n"
+       << n << " players | stack bucket " << stack << " | position "
+       << field(key, 47, 4) << " (0 = dealer) | "
+       << (line.empty() ? "unopened " : line) << "| raise/all-in %\n    ";
+    for (int j = 12; j >= 0; --j)
+      os << "   " << ranks[j];
+    os << "\n";
+
+    for (int ri = 12; ri >= 0; --ri) {
+      os << "   " << ranks[ri];
+      for (int rj = 12; rj >= 0; --rj) {
+        // Upper-right triangle suited, lower-left offsuit
+        std::vector<Card> hand = {
+            Card((Rank)std::max(ri, rj), SPADES),
+            Card((Rank)std::min(ri, rj), rj < ri ? SPADES : HEARTS)};
+        if (ri == rj)
+          hand[1].suit = HEARTS;
+        int b = em.bucketize_hand(hand, {}, PRE);
+        const Entry &e = entries[cell * NUM_BUCKETS + b];
+        if (e.num_actions == 0) {
+          os << "   -";
+          continue;
+        }
+        double aggressive = 0.0;
+        for (int s = 0; s < e.num_actions; ++s)
+          if (is_aggressive((ActionType)cell_actions[cell * SLOTS + s]))
+            aggressive += e.probs[s];
+        os << std::setw(4) << (int)std::lround(aggressive * 100);
+      }
+      os << "\n";
+    }
+  }
+}
+
+void PreflopChart::write(std::ostream &out) const {
+  uint32_t header[4] = {CHART_VERSION, (uint32_t)keys.size(),
+                        (uint32_t)NUM_BUCKETS, (uint32_t)SLOTS};
+  out.write((const char *)header, sizeof(header));
+  out.write((const char *)keys.data(), sizeof(uint64_t) * keys.size());
+  out.write((const char *)cell_actions.data(), cell_actions.size());
+  for (const Entry &e : entries) {
+    out.write((const char *)e.probs, sizeof(e.probs));
+    out.write((const char *)&e.num_actions, 1);
+  }
+}
+
+bool PreflopChart::read(std::istream &in) {
+  uint32_t header[4];
+  built = false;
+  if (!in.read((char *)header, sizeof(header)) || header[0] != CHART_VERSION ||
+      header[2] != (uint32_t)NUM_BUCKETS || header[3] != (uint32_t)SLOTS)
+    return false;
+
+  size_t cells = header[1];
+  keys.resize(cells);
+  cell_actions.resize(cells * SLOTS);
+  entries.resize(cells * NUM_BUCKETS);
+  in.read((char *)keys.data(), sizeof(uint64_t) * cells);
+  in.read((char *)cell_actions.data(), cell_actions.size());
+  for (Entry &e : entries) {
+    in.read((char *)e.probs, sizeof(e.probs));
+    in.read((char *)&e.num_actions, 1);
+  }
+  built = (bool)in && std::is_sorted(keys.begin(), keys.end());
+  return built;
+}
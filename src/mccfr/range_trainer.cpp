@@ -0,0 +1,451 @@
+#include "../../include/mccfr/range_trainer.h"
+#include "../../include/mccfr/trainer.h"
+#include <algorithm>
+
+static constexpr int MAX_ACTIONS = Trainer::MAX_ACTIONS;
+static constexpr int NUM_COMBOS = RangeTrainer::NUM_COMBOS;
+// Bucket slot of combos blocked by the board; its strategy row stays zero
+static constexpr int BLOCKED = RangeTrainer::NUM_BUCKETS;
+// Child reach, one value vector per action and the expanded strategy row
+static constexpr size_t FRAME_SIZE = (size_t)(MAX_ACTIONS + 2) * NUM_COMBOS;
+
+// The two deck indices of every hole-card combo, lowest first
+struct ComboTable {
+  uint8_t cards[NUM_COMBOS][2];
+
+  ComboTable() {
+    int c = 0;
+    for (int a = 0; a < Deck::SIZE; ++a)
+      for (int b = a + 1; b < Deck::SIZE; ++b) {
+        cards[c][0] = (uint8_t)a;
+        cards[c][1] = (uint8_t)b;
+        c++;
+      }
+  }
+};
+
+static const ComboTable combos;
+
+static int street_of(Stage stage) {
+  switch (stage) {
+  case Stage::FLOP:
+    return FLOP;
+  case Stage::TURN:
+    return TURN;
+  case Stage::RIVER:
+  case Stage::SHOWDOWN:
+    return RIVER;
+  default:
+    return PRE;
+  }
+}
+
+static bool is_aggressive(ActionType t) {
+  return t == ActionType::BET || t == ActionType::RAISE ||
+         t == ActionType::ALLIN;
+}
+
+RangeTrainer::RangeTrainer(Trainer &bp, const RangeConfig &c)
+    : blueprint(bp), cfg(c), root(nullptr, &bp.em),
+      gen(bp.seeded ? bp.seed : std::random_device{}()), nodes_visited(0),
+      num_valid(0), stronger(NUM_COMBOS) {
+  root.init_game_setup(2, cfg.stack_bb * 2.0, 1.0, 2.0);
+}
+
+double *RangeTrainer::frame(int depth) {
+  if ((int)frames.size() <= depth)
+    frames.resize(depth + 1);
+  // Buffers keep their address when the outer vector grows
+  if (frames[depth].empty())
+    frames[depth].resize(FRAME_SIZE);
+  return frames[depth].data();
+}
+
+void RangeTrainer::deal_board() {
+  Deck deck;
+  uint64_t board_mask = 0;
+  for (int i = 0; i < 5; ++i) {
+    board[i] = deck.draw_index(gen);
+    board_mask |= 1ull << board[i];
+  }
+
+  HandMask river_board;
+  for (int i = 0; i < 5; ++i)
+    river_board.add(Deck::card(board[i]));
+
+  std::vector<Card> hole, shown;
+  num_valid = 0;
+  for (int c = 0; c < NUM_COMBOS; ++c) {
+    uint64_t mask = (1ull << combos.cards[c][0]) | (1ull << combos.cards[c][1]);
+    valid[c] = (mask & board_mask) == 0;
+    if (!valid[c]) {
+      for (int st = PRE; st <= RIVER; ++st)
+        buckets[st][c] = BLOCKED;
+      ranks[c] = 0;
+      continue;
+    }
+    num_valid++;
+
+    hole = {Deck::card(combos.cards[c][0]), Deck::card(combos.cards[c][1])};
+    shown.clear();
+    for (int st = PRE; st <= RIVER; ++st) {
+      int num_shown = st == PRE ? 0 : st + 2;
+      while ((int)shown.size() < num_shown)
+        shown.push_back(Deck::card(board[shown.size()]));
+      buckets[st][c] =
+          (uint8_t)blueprint.em.bucketize_hand(hole, shown, (street)st);
+    }
+
+    HandMask hand = river_board;
+    hand.add(hole[0]);
+    hand.add(hole[1]);
+    ranks[c] = hand.score();
+  }
+
+  // Showdowns sweep the combos in rank order, one group per distinct rank
+  by_rank.clear();
+  for (int c = 0; c < NUM_COMBOS; ++c)
+    if (valid[c])
+      by_rank.push_back(c);
+  std::sort(by_rank.begin(), by_rank.end(),
+            [&](int a, int b) { return ranks[a] < ranks[b]; });
+
+  group_end.clear();
+  for (size_t i = 1; i <= by_rank.size(); ++i)
+    if (i == by_rank.size() || ranks[by_rank[i]] != ranks[by_rank[i - 1]])
+      group_end.push_back((int)i);
+}
+
+void RangeTrainer::reveal_next_street(GameState &state) {
+  size_t num_shown = state.stage == Stage::PREFLOP ? 3
+                     : state.stage == Stage::FLOP  ? 4
+                                                   : 5;
+  while (state.community_cards.size() < num_shown)
+    state.community_cards.push_back(
+        Deck::card(board[state.community_cards.size()]));
+  state.next_street();
+}
+
+void RangeTrainer::bucket_strategies(GameState &state, int player,
+                                     int num_actions, const double *reach,
+                                     bool accumulate, Node **nodes,
+                                     double *sig) {
+  const uint8_t *bk = buckets[street_of(state.stage)];
+  int count[NUM_BUCKETS + 1] = {};
+  double reach_sum[NUM_BUCKETS + 1] = {};
+  for (int c = 0; c < NUM_COMBOS; ++c) {
+    count[bk[c]]++;
+    reach_sum[bk[c]] += reach[c];
+  }
+
+  std::string key = state.compute_public_key(player, num_actions);
+  for (int b = 0; b < NUM_BUCKETS; ++b) {
+    nodes[b] = nullptr;
+    if (count[b] == 0)
+      continue;
+
+    std::string info = std::to_string(b) + "|" + key;
+    auto found = blueprint.node_map.find(info);
+    if (found == blueprint.node_map.end()) {
+      nodes[b] = blueprint.add_node(info, num_actions);
+      blueprint.counters.new_infosets[street_of(state.stage)]++;
+    } else {
+      nodes[b] = found->second;
+    }
+
+    // Strategy sums are weighted by the mean reach of the bucket's hands
+    double weight = accumulate ? reach_sum[b] / count[b] : 0.0;
+    nodes[b]->get_strategy(weight, sig + b * MAX_ACTIONS);
+  }
+}
+
+bool RangeTrainer::play_prefix(GameState &state, double *reach0,
+                               double *reach1) {
+  int raises = 0;
+  while (state.stage < cfg.start) {
+    if (state.is_terminal() || Trainer::is_allin_runout(state))
+      return false;
+    if (state.is_betting_round_over()) {
+      reveal_next_street(state);
+      raises = 0;
+      continue;
+    }
+
+    // Check/call, or open the smallest bet/raise once per street
+    int acting = state.get_current_player()->id;
+    ActionList legal = state.get_legal_actions();
+    int passive = -1, aggressive = -1;
+    for (size_t i = 0; i < legal.size(); ++i) {
+      ActionType t = legal[i].type;
+      if (t == ActionType::CHECK || t == ActionType::CALL)
+        passive = passive < 0 ? (int)i : passive;
+      else if ((t == ActionType::BET || t == ActionType::RAISE) &&
+               aggressive < 0)
+        aggressive = (int)i;
+    }
+    int a = passive;
+    if (aggressive >= 0 && raises == 0 && (gen() & 1))
+      a = aggressive;
+
+    // Each range keeps the hands whose blueprint takes this line
+    double *reach = acting == 0 ? reach0 : reach1;
+    const uint8_t *bk = buckets[street_of(state.stage)];
+    std::string key = state.compute_public_key(acting, legal.size());
+    double prob[NUM_BUCKETS + 1];
+    prob[BLOCKED] = 0.0;
+    for (int b = 0; b < NUM_BUCKETS; ++b) {
+      auto found = blueprint.node_map.find(std::to_string(b) + "|" + key);
+      double avg[MAX_ACTIONS];
+      if (found != blueprint.node_map.end()) {
+        found->second->write_average_strategy(avg);
+        prob[b] = avg[a];
+      } else {
+        prob[b] = 1.0 / legal.size();
+      }
+    }
+    for (int c = 0; c < NUM_COMBOS; ++c)
+      reach[c] *= prob[bk[c]];
+
+    if (is_aggressive(legal[a].type))
+      raises++;
+    state.apply_action(legal[a], true);
+  }
+  return !state.is_terminal();
+}
+
+void RangeTrainer::fold_values(GameState &state, int traverser,
+                               const double *opp_reach, double *values) {
+  double contrib[2], payoff[2];
+  bool folded[2];
+  int no_ranks[2] = {0, 0};
+  for (int i = 0; i < 2; ++i) {
+    contrib[i] = state.players[i].total_bet_size;
+    folded[i] = state.players[i].is_folded;
+  }
+  settle_pots(2, contrib, folded, no_ranks, payoff);
+  double won = payoff[traverser] / num_valid;
+
+  // Opponent reach compatible with each combo: everything minus the hands
+  // sharing one of its cards (the combo itself was subtracted twice)
+  double total = 0.0, per_card[Deck::SIZE] = {};
+  for (int c = 0; c < NUM_COMBOS; ++c) {
+    total += opp_reach[c];
+    per_card[combos.cards[c][0]] += opp_reach[c];
+    per_card[combos.cards[c][1]] += opp_reach[c];
+  }
+  for (int c = 0; c < NUM_COMBOS; ++c) {
+    double compat = total - per_card[combos.cards[c][0]] -
+                    per_card[combos.cards[c][1]] + opp_reach[c];
+    values[c] = valid[c] ? won * compat : 0.0;
+  }
+}
+
+void RangeTrainer::showdown_values(GameState &state, int traverser,
+                                   const double *opp_reach, double *values) {
+  // Chips won, lost and split, side pots included
+  double contrib[2], win[2], lose[2], tie[2];
+  bool folded[2] = {false, false};
+  for (int i = 0; i < 2; ++i)
+    contrib[i] = state.players[i].total_bet_size;
+  int opp = 1 - traverser;
+  int ranks_win[2], ranks_lose[2], ranks_tie[2] = {0, 0};
+  ranks_win[traverser] = 1;
+  ranks_win[opp] = 0;
+  ranks_lose[traverser] = 0;
+  ranks_lose[opp] = 1;
+  settle_pots(2, contrib, folded, ranks_win, win);
+  settle_pots(2, contrib, folded, ranks_lose, lose);
+  settle_pots(2, contrib, folded, ranks_tie, tie);
+  double w = win[traverser] / num_valid, l = lose[traverser] / num_valid,
+         t = tie[traverser] / num_valid;
+
+  // Ascending sweep: opponent reach of strictly weaker compatible hands.
+  // Every combo of a rank group reads the sums before the group is added.
+  double *beats = values; // reused for the final values below
+  double *loses = stronger.data();
+  double sum = 0.0, per_card[Deck::SIZE] = {};
+  size_t begin = 0;
+  for (int end : group_end) {
+    for (size_t i = begin; i < (size_t)end; ++i) {
+      int c = by_rank[i];
+      beats[c] = sum - per_card[combos.cards[c][0]] -
+                 per_card[combos.cards[c][1]];
+    }
+    for (size_t i = begin; i < (size_t)end; ++i) {
+      int c = by_rank[i];
+      sum += opp_reach[c];
+      per_card[combos.cards[c][0]] += opp_reach[c];
+      per_card[combos.cards[c][1]] += opp_reach[c];
+    }
+    begin = end;
+  }
+  double total = sum;
+  double all_card[Deck::SIZE];
+  std::copy(per_card, per_card + Deck::SIZE, all_card);
+
+  // Descending sweep: strictly stronger compatible hands
+  sum = 0.0;
+  std::fill(per_card, per_card + Deck::SIZE, 0.0);
+  size_t end = by_rank.size();
+  for (int g = (int)group_end.size() - 1; g >= 0; --g) {
+    size_t first = g > 0 ? group_end[g - 1] : 0;
+    for (size_t i = first; i < end; ++i) {
+      int c = by_rank[i];
+      loses[c] = sum - per_card[combos.cards[c][0]] -
+                 per_card[combos.cards[c][1]];
+    }
+    for (size_t i = first; i < end; ++i) {
+      int c = by_rank[i];
+      sum += opp_reach[c];
+      per_card[combos.cards[c][0]] += opp_reach[c];
+      per_card[combos.cards[c][1]] += opp_reach[c];
+    }
+    end = first;
+  }
+
+  for (int c = 0; c < NUM_COMBOS; ++c) {
+    if (!valid[c]) {
+      values[c] = 0.0;
+      continue;
+    }
+    double compat = total - all_card[combos.cards[c][0]] -
+                    all_card[combos.cards[c][1]] + opp_reach[c];
+    double split = compat - beats[c] - loses[c];
+    values[c] = w * beats[c] + l * loses[c] + t * split;
+  }
+}
+
+void RangeTrainer::walk(GameState &state, int traverser,
+                        const double *own_reach, const double *opp_reach,
+                        double *values, int raises, int depth) {
+  nodes_visited++;
+
+  if (state.is_terminal()) {
+    if (state.get_active_player_count() <= 1)
+      fold_values(state, traverser, opp_reach, values);
+    else
+      showdown_values(state, traverser, opp_reach, values);
+    return;
+  }
+
+  if (state.is_betting_round_over()) {
+    // The whole board is known, so an all-in goes straight to showdown
+    if (Trainer::is_allin_runout(state)) {
+      showdown_values(state, traverser, opp_reach, values);
+      return;
+    }
+    reveal_next_street(state);
+    raises = 0;
+  }
+
+  int acting = state.get_current_player()->id;
+  ActionList legal = state.get_legal_actions();
+  int num_actions = legal.size();
+  if (num_actions == 0) {
+    showdown_values(state, traverser, opp_reach, values);
+    return;
+  }
+
+  // Past the raise cap only folds, checks and calls are explored; those
+  // nodes keep the blueprint key and size but not its strategy sums
+  bool allowed[MAX_ACTIONS];
+  bool capped = raises >= cfg.max_raises;
+  for (int a = 0; a < num_actions; ++a)
+    allowed[a] = !(capped && is_aggressive(legal[a].type));
+
+  bool is_traverser = acting == traverser;
+  const double *acting_reach = is_traverser ? own_reach : opp_reach;
+  Node *nodes[NUM_BUCKETS];
+  double sig[(NUM_BUCKETS + 1) * MAX_ACTIONS] = {};
+  bucket_strategies(state, acting, num_actions, acting_reach,
+                    is_traverser && !capped, nodes, sig);
+
+  if (capped) {
+    for (int b = 0; b < NUM_BUCKETS; ++b) {
+      double *row = sig + b * MAX_ACTIONS;
+      double sum = 0.0;
+      int open = 0;
+      for (int a = 0; a < num_actions; ++a) {
+        row[a] = allowed[a] ? row[a] : 0.0;
+        sum += row[a];
+        open += allowed[a];
+      }
+      for (int a = 0; a < num_actions; ++a)
+        row[a] = !allowed[a] ? 0.0 : sum > 0 ? row[a] / sum : 1.0 / open;
+    }
+  }
+
+  const uint8_t *bk = buckets[street_of(state.stage)];
+  double *f = frame(depth);
+  double *child = f;
+  double *action_values = f + NUM_COMBOS;
+  double *expanded = f + (size_t)(MAX_ACTIONS + 1) * NUM_COMBOS;
+
+  std::fill(values, values + NUM_COMBOS, 0.0);
+  for (int a = 0; a < num_actions; ++a) {
+    if (!allowed[a])
+      continue;
+
+    for (int c = 0; c < NUM_COMBOS; ++c)
+      expanded[c] = sig[bk[c] * MAX_ACTIONS + a];
+    for (int c = 0; c < NUM_COMBOS; ++c)
+      child[c] = acting_reach[c] * expanded[c];
+
+    GameState next = state;
+    next.apply_action(legal[a], true);
+    int next_raises = raises + is_aggressive(legal[a].type);
+    double *va = action_values + (size_t)a * NUM_COMBOS;
+
+    if (is_traverser) {
+      walk(next, traverser, child, opp_reach, va, next_raises, depth + 1);
+      for (int c = 0; c < NUM_COMBOS; ++c)
+        values[c] += expanded[c] * va[c];
+    } else {
+      walk(next, traverser, own_reach, child, va, next_raises, depth + 1);
+      for (int c = 0; c < NUM_COMBOS; ++c)
+        values[c] += va[c];
+    }
+  }
+
+  if (!is_traverser)
+    return;
+
+  // Regret of a bucket sums its hands, each with its 1/num_valid chance of
+  // being dealt, which matches one sampled deal of the trainer in expectation
+  for (int a = 0; a < num_actions; ++a) {
+    if (!allowed[a])
+      continue;
+    const double *va = action_values + (size_t)a * NUM_COMBOS;
+    double regret[NUM_BUCKETS + 1] = {};
+    for (int c = 0; c < NUM_COMBOS; ++c)
+      regret[bk[c]] += va[c] - values[c];
+    for (int b = 0; b < NUM_BUCKETS; ++b)
+      if (nodes[b])
+        nodes[b]->update_regret_sum(a, regret[b] / num_valid);
+  }
+}
+
+void RangeTrainer::train(int iterations) {
+  nodes_visited = 0;
+  std::vector<double> reach[2] = {std::vector<double>(NUM_COMBOS),
+                                  std::vector<double>(NUM_COMBOS)};
+  std::vector<double> values(NUM_COMBOS);
+
+  for (int i = 0; i < iterations; ++i) {
+    deal_board();
+    for (auto &r : reach)
+      for (int c = 0; c < NUM_COMBOS; ++c)
+        r[c] = valid[c];
+
+    GameState state = root;
+    state.start_hand(0);
+    if (!play_prefix(state, reach[0].data(), reach[1].data()))
+      continue;
+
+    for (int traverser = 0; traverser < 2; ++traverser) {
+      GameState start = state;
+      walk(start, traverser, reach[traverser].data(),
+           reach[1 - traverser].data(), values.data(), 0, 0);
+    }
+  }
+}
@@ -0,0 +1,319 @@
+#include "../../include/mccfr/shard.h"
+#include "../../include/mccfr/trainer.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const char TABLE_MAGIC[4] = {'P', 'B', 'T', 'B'};
+static const uint32_t TABLE_VERSION = 1;
+static const uint32_t END_OF_TABLE = 0xFFFFFFFFu;
+
+//
+// ----------------------------------------------
+// Table I/O
+// ----------------------------------------------
+//
+
+TableWriter::TableWriter(const std::string &fn)
+    : out(fn, std::ios::binary | std::ios::trunc) {
+  if (!out)
+    return;
+  out.write(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+  out.write((const char *)&TABLE_VERSION, sizeof(TABLE_VERSION));
+}
+
+void TableWriter::write(const std::string &key,
+                        const std::vector<double> &regret_sum,
+                        const std::vector<double> &strategy_sum) {
+  uint32_t len = key.size();
+  uint32_t k = regret_sum.size();
+  out.write((const char *)&len, sizeof(len));
+  out.write(key.data(), len);
+  out.write((const char *)&k, sizeof(k));
+  out.write((const char *)regret_sum.data(), sizeof(double) * k);
+  out.write((const char *)strategy_sum.data(), sizeof(double) * k);
+}
+
+bool TableWriter::close() {
+  out.write((const char *)&END_OF_TABLE, sizeof(END_OF_TABLE));
+  out.close();
+  return !out.fail();
+}
+
+TableReader::TableReader(const std::string &fn)
+    : in(fn, std::ios::binary), has_record(false) {
+  if (!in)
+    return;
+
+  char magic[4];
+  uint32_t version = 0;
+  in.read(magic, sizeof(magic));
+  in.read((char *)&version, sizeof(version));
+  if (!in || !std::equal(magic, magic + 4, TABLE_MAGIC) ||
+      version != TABLE_VERSION) {
+    std::cerr << "Not a node table: " << fn << "\n";
+    in.close();
+    return;
+  }
+  next();
+}
+
+bool TableReader::next() {
+  has_record = false;
+
+  uint32_t len;
+  if (!in.read((char *)&len, sizeof(len)) || len == END_OF_TABLE)
+    return false;
+
+  record.key.resize(len);
+  in.read(&record.key[0], len);
+
+  uint32_t k;
+  in.read((char *)&k, sizeof(k));
+  record.regret_sum.resize(k);
+  record.strategy_sum.resize(k);
+  in.read((char *)record.regret_sum.data(), sizeof(double) * k);
+  in.read((char *)record.strategy_sum.data(), sizeof(double) * k);
+
+  has_record = (bool)in;
+  return has_record;
+}
+
+//
+// ----------------------------------------------
+// Streaming merge
+// ----------------------------------------------
+//
+
+std::string shard_model_path(const ShardConfig &cfg, int round) {
+  if (round < 0)
+    return "";
+  return cfg.dir + "/table_r" + std::to_string(round) + ".bin";
+}
+
+std::string shard_delta_path(const ShardConfig &cfg, int round, int shard) {
+  return cfg.dir + "/delta_r" + std::to_string(round) + "_s" +
+         std::to_string(shard) + ".bin";
+}
+
+bool merge_shard_round(const ShardConfig &cfg, int round) {
+  std::vector<std::unique_ptr<TableReader>> inputs;
+
+  std::string base = shard_model_path(cfg, round - 1);
+  if (!base.empty())
+    inputs.push_back(std::make_unique<TableReader>(base));
+
+  for (int s = 0; s < cfg.num_shards; ++s) {
+    std::string fn = shard_delta_path(cfg, round, s);
+    inputs.push_back(std::make_unique<TableReader>(fn));
+    if (!inputs.back()->is_open()) {
+      std::cerr << "Missing shard delta " << fn << "\n";
+      return false;
+    }
+  }
+
+  // Min-heap of input indices ordered by their current key
+  auto cmp = [&](size_t a, size_t b) {
+    return inputs[a]->record.key > inputs[b]->record.key;
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(cmp)> heap(cmp);
+  for (size_t i = 0; i < inputs.size(); ++i)
+    if (inputs[i]->ok())
+      heap.push(i);
+
+  std::string out_fn = shard_model_path(cfg, round);
+  std::string tmp_fn = out_fn + ".tmp";
+  TableWriter writer(tmp_fn);
+  if (!writer.ok()) {
+    std::cerr << "Cannot write table " << tmp_fn << "\n";
+    return false;
+  }
+
+  TableRecord merged;
+  while (!heap.empty()) {
+    size_t i = heap.top();
+    heap.pop();
+    merged = inputs[i]->record;
+
+    // Sum every input currently sitting on the same key
+    while (!heap.empty() && inputs[heap.top()]->record.key == merged.key) {
+      size_t j = heap.top();
+      heap.pop();
+      const TableRecord &rec = inputs[j]->record;
+      // Same key, same abstraction: the action lists must agree
+      if (rec.regret_sum.size() != merged.regret_sum.size()) {
+        std::cerr << "Cannot merge info set '" << merged.key << "': "
+                  << merged.regret_sum.size() << " actions in one input, "
+                  << rec.regret_sum.size() << " in another\n";
+        writer.close();
+        std::remove(tmp_fn.c_str());
+        return false;
+      }
+      for (size_t a = 0; a < merged.regret_sum.size(); ++a) {
+        merged.regret_sum[a] += rec.regret_sum[a];
+        merged.strategy_sum[a] += rec.strategy_sum[a];
+      }
+      if (inputs[j]->next())
+        heap.push(j);
+    }
+    if (inputs[i]->next())
+      heap.push(i);
+
+    writer.write(merged.key, merged.regret_sum, merged.strategy_sum);
+  }
+
+  if (!writer.close())
+    return false;
+
+  // Publishing the table with a rename is the broadcast to the next round
+  return std::rename(tmp_fn.c_str(), out_fn.c_str()) == 0;
+}
+
+bool export_table_model(const std::string &table_fn,
+                        const std::string &model_fn) {
+  TableReader reader(table_fn);
+  std::ofstream out(model_fn, std::ios::binary);
+  if (!reader.is_open() || !out) {
+    std::cerr << "Cannot export " << table_fn << " to " << model_fn << "\n";
+    return false;
+  }
+
+  // Node count is patched in once the table has been streamed
+  size_t N = 0;
+  out.write((char *)&N, sizeof(N));
+  uint64_t regret_bytes = sizeof(uint64_t);
+
+  for (; reader.ok(); reader.next()) {
+    const TableRecord &rec = reader.record;
+    size_t len = rec.key.size();
+    out.write((char *)&len, sizeof(len));
+    out.write(rec.key.c_str(), len);
+
+    size_t k = rec.strategy_sum.size();
+    out.write((char *)&k, sizeof(k));
+    out.write((char *)rec.strategy_sum.data(), sizeof(double) * k);
+    regret_bytes += sizeof(double) * k;
+    N++;
+  }
+
+  active_abstraction().write_section(out);
+
+  // Second pass over the table for the regrets, in the same node order
+  uint64_t count = N;
+  out.write((const char *)&Trainer::SECTION_REGRETS,
+            sizeof(Trainer::SECTION_REGRETS));
+  out.write((char *)&regret_bytes, sizeof(regret_bytes));
+  out.write((char *)&count, sizeof(count));
+  size_t written = 0;
+  for (TableReader again(table_fn); again.ok(); again.next()) {
+    const TableRecord &rec = again.record;
+    out.write((const char *)rec.regret_sum.data(),
+              sizeof(double) * rec.regret_sum.size());
+    written++;
+  }
+  if (written != N) {
+    std::cerr << "Cannot re-read " << table_fn << " for its regrets\n";
+    return false;
+  }
+
+  out.seekp(0);
+  out.write((char *)&N, sizeof(N));
+  return !out.fail();
+}
+
+//
+// ----------------------------------------------
+// Worker processes
+// ----------------------------------------------
+//
+
+// Independent seed stream per (shard, round)
+static unsigned shard_seed(unsigned base, int shard, int round) {
+  uint64_t z = ((uint64_t)base << 32) ^ ((uint64_t)shard << 16) ^ round;
+  z += 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return (unsigned)(z ^ (z >> 31));
+}
+
+static int run_worker(GameState *game, const ShardConfig &cfg, int shard,
+                      int round) {
+  Trainer trainer(game);
+  trainer.set_node_store(cfg.node_store);
+  std::string base = shard_model_path(cfg, round - 1);
+  if (!base.empty() && !trainer.load_table(base))
+    return 1;
+
+  trainer.set_seed(shard_seed(cfg.base_seed, shard, round));
+  trainer.set_presample_runouts(cfg.presample_runouts);
+  trainer.train(cfg.iterations_per_round);
+
+  return trainer.save_table_delta(base, shard_delta_path(cfg, round, shard))
+             ? 0
+             : 1;
+}
+
+int run_shard_training(GameState *game, const ShardConfig &cfg,
+                       const std::string &model_fn) {
+  std::error_code ec;
+  std::filesystem::create_directories(cfg.dir, ec);
+  if (ec) {
+    std::cerr << "Cannot create shard directory " << cfg.dir << "\n";
+    return 1;
+  }
+
+  for (int round = 0; round < cfg.rounds; ++round) {
+    std::cout << "Shard round " << round + 1 << "/" << cfg.rounds << ": "
+              << cfg.num_shards << " workers x " << cfg.iterations_per_round
+              << " iterations\n";
+    std::cout.flush();
+
+    std::vector<pid_t> workers;
+    for (int s = 0; s < cfg.num_shards; ++s) {
+      pid_t pid = fork();
+      if (pid < 0) {
+        std::cerr << "fork failed for shard " << s << "\n";
+        break;
+      }
+      if (pid == 0) {
+        int rc = run_worker(game, cfg, s, round);
+        std::cout.flush();
+        _exit(rc);
+      }
+      workers.push_back(pid);
+    }
+
+    bool failed = (int)workers.size() != cfg.num_shards;
+    for (pid_t pid : workers) {
+      int status = 0;
+      if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+          WEXITSTATUS(status) != 0)
+        failed = true;
+    }
+    if (failed) {
+      std::cerr << "Shard worker failed in round " << round << "\n";
+      return 1;
+    }
+
+    if (!merge_shard_round(cfg, round)) {
+      std::cerr << "Merge failed in round " << round << "\n";
+      return 1;
+    }
+
+    for (int s = 0; s < cfg.num_shards; ++s)
+      std::filesystem::remove(shard_delta_path(cfg, round, s), ec);
+    if (round > 0)
+      std::filesystem::remove(shard_model_path(cfg, round - 1), ec);
+  }
+
+  if (cfg.rounds <= 0)
+    return 0;
+  return export_table_model(shard_model_path(cfg, cfg.rounds - 1), model_fn)
+             ? 0
+             : 1;
+}
@@ -0,0 +1,375 @@
+#include "../../include/mccfr/subgame_solver.h"
+#include "../../include/mccfr/trainer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+SubgameSolver::SubgameSolver(Trainer &bp, const ResolveConfig &c)
+    : blueprint(bp), cfg(c) {}
+
+namespace {
+
+// A decision of the public line: who acted, the legal action they took and
+// the card-independent part of their info set
+struct LineDecision {
+  int player;
+  int action;
+  std::string public_key;
+  std::vector<Card> board;
+  street st;
+};
+
+street street_of(Stage stage) {
+  switch (stage) {
+  case Stage::FLOP:
+    return FLOP;
+  case Stage::TURN:
+    return TURN;
+  case Stage::RIVER:
+    return RIVER;
+  default:
+    return PRE;
+  }
+}
+
+// Legal action closest to a recorded one: same type (bets and raises alike)
+// and the nearest amount; -1 when none matches
+int match_action(const ActionList &legal, const Action &taken) {
+  auto sizing = [](ActionType t) {
+    return t == ActionType::BET || t == ActionType::RAISE;
+  };
+  int best = -1;
+  double best_gap = 0;
+  for (size_t i = 0; i < legal.size(); ++i) {
+    Action a = legal[i];
+    if (a.type != taken.type && !(sizing(a.type) && sizing(taken.type)))
+      continue;
+    double gap = std::abs(a.amount - taken.amount);
+    if (best < 0 || gap < best_gap) {
+      best = i;
+      best_gap = gap;
+    }
+  }
+  return best;
+}
+
+// Replays `live` from the blinds and records every decision on the way;
+// false when its history does not lead back to the same spot
+bool replay_line(const GameState &live, std::vector<LineDecision> &line) {
+  GameState s = live;
+  s.risk_profiler = nullptr;
+  for (auto &p : s.players)
+    p.stack += p.total_bet_size;
+  s.start_hand(live.dealer_index);
+
+  for (const Action &h : live.history) {
+    if (s.is_terminal() || s.get_current_player()->id != h.player_id)
+      return false;
+    auto legal = s.get_legal_actions();
+    int a = match_action(legal, h);
+    if (a >= 0)
+      line.push_back({h.player_id, a,
+                      s.compute_public_key(h.player_id, legal.size()),
+                      s.community_cards, street_of(s.stage)});
+    s.apply_action(Action(h.player_id, h.type, h.amount), true);
+
+    if (!s.is_terminal() && s.is_betting_round_over()) {
+      s.next_street();
+      size_t need = s.stage == Stage::FLOP   ? 3
+                    : s.stage == Stage::TURN ? 4
+                                             : 5;
+      if (live.community_cards.size() < need)
+        return false;
+      s.set_community_cards(std::vector<Card>(
+          live.community_cards.begin(), live.community_cards.begin() + need));
+    }
+  }
+  return !s.is_terminal() && s.stage == live.stage &&
+         s.current_player_index == live.current_player_index;
+}
+
+} // namespace
+
+std::vector<SubgameSolver::Range>
+SubgameSolver::build_ranges(const GameState &root) {
+  std::vector<LineDecision> line;
+  if (!replay_line(root, line))
+    line.clear();
+
+  uint64_t dead = 0;
+  for (const auto &c : root.community_cards)
+    dead |= 1ull << Deck::index(c);
+
+  std::vector<Range> ranges(root.players.size());
+  std::vector<Card> hand(2, Deck::card(0));
+  for (const Player &p : root.players) {
+    if (p.is_folded || p.id < 0 || p.id >= (int)ranges.size())
+      continue;
+
+    // Blueprint probability of the action taken, per decision and hand
+    // bucket, filled in as buckets come up (-1 = not looked up yet)
+    std::vector<std::vector<double>> taken(line.size());
+    auto taken_prob = [&](size_t k, int bucket) {
+      std::vector<double> &cache = taken[k];
+      if (bucket >= (int)cache.size())
+        cache.resize(bucket + 1, -1.0);
+      if (cache[bucket] < 0) {
+        const LineDecision &d = line[k];
+        std::vector<double> probs = blueprint.get_strategy(
+            std::to_string(bucket) + "|" + d.public_key);
+        // No node: the line says nothing about this bucket
+        cache[bucket] = d.action < (int)probs.size() ? probs[d.action] : 1.0;
+      }
+      return cache[bucket];
+    };
+
+    Range &r = ranges[p.id];
+    double total = 0;
+    for (int a = 0; a < Deck::SIZE; ++a) {
+      for (int b = a + 1; b < Deck::SIZE; ++b) {
+        if ((dead >> a & 1) || (dead >> b & 1))
+          continue;
+        hand[0] = Deck::card(a);
+        hand[1] = Deck::card(b);
+        double w = 1.0;
+        for (size_t k = 0; k < line.size() && w > 0; ++k) {
+          if (line[k].player != p.id)
+            continue;
+          int bucket = root.equity_module->bucketize_hand(hand, line[k].board,
+                                                          line[k].st);
+          w *= taken_prob(k, bucket);
+        }
+        total += w;
+        r.cards.push_back(a);
+        r.cards.push_back(b);
+        r.cumulative.push_back(total);
+      }
+    }
+    // A line the blueprint never takes: fall back to every combo
+    if (total <= 0)
+      for (size_t i = 0; i < r.cumulative.size(); ++i)
+        r.cumulative[i] = i + 1;
+  }
+  return ranges;
+}
+
+void SubgameSolver::sample_hidden_cards(GameState &state,
+                                        const std::vector<Range> &ranges,
+                                        std::mt19937 &gen) {
+  Deck deck;
+  deck.remove(state.community_cards);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  // Seats with a range first, from a random seat on so no seat always gets
+  // the first pick; folded seats then take what is left
+  int n = state.players.size();
+  int first = gen() % n;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int k = 0; k < n; ++k) {
+      Player &p = state.players[(first + k) % n];
+      const Range *r = p.id >= 0 && p.id < (int)ranges.size() &&
+                               !ranges[p.id].cumulative.empty()
+                           ? &ranges[p.id]
+                           : nullptr;
+      if ((pass == 0) != (r != nullptr))
+        continue;
+      p.hole_cards.clear();
+      // Redraw combos blocked by hands already dealt, a few times
+      for (int tries = 0; r && tries < 32; ++tries) {
+        double x = unit(gen) * r->cumulative.back();
+        size_t i = std::upper_bound(r->cumulative.begin(),
+                                    r->cumulative.end(), x) -
+                   r->cumulative.begin();
+        i = std::min(i, r->cumulative.size() - 1);
+        Card a = Deck::card(r->cards[2 * i]);
+        Card b = Deck::card(r->cards[2 * i + 1]);
+        if (deck.contains(a) && deck.contains(b)) {
+          deck.remove(a);
+          deck.remove(b);
+          p.hole_cards = {a, b};
+          break;
+        }
+      }
+      if (p.hole_cards.empty())
+        deck.draw(gen, 2, p.hole_cards);
+    }
+  }
+}
+
+bool SubgameSolver::advance_street(GameState &state, std::mt19937 &gen) {
+  if (state.is_betting_round_over() && state.stage != Stage::SHOWDOWN) {
+    if (state.stage == Stage::PREFLOP && state.community_cards.empty())
+      blueprint.deal_random_community_cards(state, 3, gen);
+    else if (state.stage == Stage::FLOP && state.community_cards.size() == 3)
+      blueprint.deal_random_community_cards(state, 1, gen);
+    else if (state.stage == Stage::TURN && state.community_cards.size() == 4)
+      blueprint.deal_random_community_cards(state, 1, gen);
+    state.next_street();
+  }
+  return state.is_terminal();
+}
+
+// Plays the hand out with the blueprint average strategy
+double SubgameSolver::rollout(GameState state, int traverser,
+                              std::mt19937 &gen) {
+  for (int steps = 0; steps < 200; ++steps) {
+    if (state.is_terminal() || advance_street(state, gen))
+      break;
+
+    int acting = state.get_current_player()->id;
+    auto legal = state.get_legal_actions();
+    if (legal.empty())
+      break;
+
+    std::vector<double> probs = blueprint.get_strategy(
+        state.compute_information_set(acting, legal.size()));
+    if (probs.size() != legal.size())
+      probs.assign(legal.size(), 1.0);
+
+    std::discrete_distribution<> dist(probs.begin(), probs.end());
+    state.apply_action(legal[dist(gen)], true);
+  }
+  return blueprint.get_terminal_payoff(state, traverser);
+}
+
+double SubgameSolver::leaf_value(GameState &state, int traverser,
+                                 std::mt19937 &gen) {
+  int n = std::max(1, cfg.leaf_rollouts);
+  double total = 0.0;
+  for (int i = 0; i < n; ++i)
+    total += rollout(state, traverser, gen);
+  return total / n;
+}
+
+double SubgameSolver::cfr(NodeTable &nodes, GameState &state, int traverser,
+                          std::vector<double> &reach, std::mt19937 &gen,
+                          int depth) {
+  if (state.is_terminal() || advance_street(state, gen))
+    return blueprint.get_terminal_payoff(state, traverser);
+
+  if (depth >= cfg.depth_limit)
+    return leaf_value(state, traverser, gen);
+
+  int acting = state.get_current_player()->id;
+  auto legal = state.get_legal_actions();
+  if (legal.empty())
+    return blueprint.get_terminal_payoff(state, traverser);
+  std::string info = state.compute_information_set(acting, legal.size());
+
+  Node &node = nodes.try_emplace(info, (int)legal.size()).first->second;
+  double strategy[Trainer::MAX_ACTIONS];
+  node.get_strategy(reach[acting], strategy);
+
+  if (acting == traverser) {
+    double node_util = 0.0;
+    double utils[Trainer::MAX_ACTIONS];
+
+    for (size_t i = 0; i < legal.size(); ++i) {
+      GameState next = state;
+      next.apply_action(legal[i], true);
+
+      std::vector<double> next_reach = reach;
+      next_reach[traverser] *= strategy[i];
+
+      utils[i] = cfr(nodes, next, traverser, next_reach, gen, depth + 1);
+      node_util += strategy[i] * utils[i];
+    }
+
+    double scale = 1.0;
+    for (size_t p = 0; p < reach.size(); ++p) {
+      if ((int)p != traverser)
+        scale *= reach[p];
+    }
+    for (size_t i = 0; i < legal.size(); ++i)
+      node.update_regret_sum(i, (utils[i] - node_util) * scale);
+
+    return node_util;
+  }
+
+  std::discrete_distribution<> dist(strategy, strategy + legal.size());
+  int a = dist(gen);
+
+  GameState next = state;
+  next.apply_action(legal[a], true);
+
+  std::vector<double> next_reach = reach;
+  next_reach[acting] *= strategy[a];
+
+  return cfr(nodes, next, traverser, next_reach, gen, depth + 1);
+}
+
+std::vector<double> SubgameSolver::solve(const GameState &live,
+                                         int player_id) {
+  auto t0 = std::chrono::steady_clock::now();
+  auto deadline = t0 + std::chrono::milliseconds(cfg.budget_ms);
+
+  GameState root = live;
+  root.risk_profiler = nullptr; // simulated actions must not reach profiles
+
+  Player *hero = root.get_player(player_id);
+  auto legal = root.get_legal_actions();
+  if (!hero || hero->hole_cards.size() < 2 || legal.empty() ||
+      root.get_current_player()->id != player_id)
+    return {};
+
+  // The hero's real info set; solving samples the hero's hand like any other
+  std::string root_info = root.compute_information_set(player_id);
+  std::vector<Range> ranges = build_ranges(root);
+
+  int threads = cfg.num_threads > 0
+                    ? cfg.num_threads
+                    : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::vector<double>> root_sums(threads);
+  unsigned base_seed = std::random_device{}();
+
+  auto worker = [&](int t) {
+    NodeTable nodes;
+    std::mt19937 gen(base_seed + 7919 * t);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      GameState s = root;
+      sample_hidden_cards(s, ranges, gen);
+
+      for (const auto &p : s.players) {
+        if (p.is_folded)
+          continue;
+        GameState copy = s;
+        std::vector<double> reach(s.num_players, 1.0);
+        cfr(nodes, copy, p.id, reach, gen, 0);
+      }
+    }
+
+    auto it = nodes.find(root_info);
+    if (it != nodes.end())
+      root_sums[t] = it->second.get_strategy_sum();
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(worker, t);
+  worker(0);
+  for (auto &th : pool)
+    th.join();
+
+  std::vector<double> probs(legal.size(), 0.0);
+  double total = 0.0;
+  for (const auto &sums : root_sums) {
+    for (size_t a = 0; a < sums.size() && a < probs.size(); ++a) {
+      probs[a] += sums[a];
+      total += sums[a];
+    }
+  }
+
+  if (total > 0) {
+    for (double &p : probs)
+      p /= total;
+  } else {
+    probs = blueprint.get_strategy(root_info);
+  }
+
+  latencies.record(std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - t0)
+                       .count());
+  return probs;
+}
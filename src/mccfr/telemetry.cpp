@@ -0,0 +1,178 @@
+#include "../../include/mccfr/telemetry.h"
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+MemoryProbe::MemoryProbe(bool enabled) : tlb_fd(-1) {
+  if (!enabled)
+    return;
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.exclude_kernel = 1; // allowed at perf_event_paranoid 2
+  attr.exclude_hv = 1;
+  tlb_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+MemoryProbe::~MemoryProbe() {
+  if (tlb_fd >= 0)
+    close(tlb_fd);
+}
+
+MemorySample MemoryProbe::sample() const {
+  MemorySample m;
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    m.minor_faults = usage.ru_minflt;
+    m.major_faults = usage.ru_majflt;
+  }
+  uint64_t misses;
+  if (tlb_fd >= 0 && read(tlb_fd, &misses, sizeof(misses)) == sizeof(misses))
+    m.dtlb_misses = misses;
+
+  std::ifstream smaps("/proc/self/smaps_rollup");
+  std::string field;
+  int64_t kb;
+  while (smaps >> field) {
+    if (field == "AnonHugePages:" && smaps >> kb) {
+      m.thp_bytes = kb * 1024;
+      break;
+    }
+    smaps.ignore(1 << 10, '\n');
+  }
+  return m;
+}
+
+TelemetryEmitter::TelemetryEmitter(std::ostream *o,
+                                   const TrainingCounters &baseline)
+    : out(o), start(std::chrono::steady_clock::now()), last_time(start),
+      last(baseline), memory(o != nullptr), last_memory(memory.sample()) {}
+
+void TelemetryEmitter::emit(const TrainingCounters &c, size_t node_count,
+                            size_t bucket_count, double load_factor) {
+  if (!out)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time).count();
+  double elapsed = std::chrono::duration<double>(now - start).count();
+  if (dt <= 0)
+    dt = 1e-9;
+
+  uint64_t terminals = c.terminal_evals - last.terminal_evals;
+  double avg_depth =
+      terminals > 0
+          ? (double)(c.terminal_depth_sum - last.terminal_depth_sum) / terminals
+          : 0.0;
+
+  // Node payloads plus the bucket array of the hash table
+  uint64_t table_bytes = c.node_bytes + bucket_count * sizeof(void *);
+
+  const char *streets[4] = {"preflop", "flop", "turn", "river"};
+
+  std::ostream &os = *out;
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  os << "{\"iteration\":" << c.iterations << ",\"elapsed_s\":" << elapsed
+     << ",\"iterations_per_s\":" << (c.iterations - last.iterations) / dt
+     << ",\"nodes_visited_per_s\":"
+     << (c.nodes_visited - last.nodes_visited) / dt
+     << ",\"terminal_evals_per_s\":" << terminals / dt
+     << ",\"node_count\":" << node_count << ",\"node_table_bytes\":"
+     << table_bytes << ",\"load_factor\":" << load_factor
+     << ",\"avg_depth\":" << avg_depth << ",\"new_infosets\":{";
+  for (int s = 0; s < 4; ++s) {
+    os << (s ? "," : "") << "\"" << streets[s]
+       << "\":" << c.new_infosets[s] - last.new_infosets[s];
+  }
+  os << "},\"node_store_bytes\":" << c.store_bytes
+     << ",\"node_store_huge_chunks\":" << c.store_huge_chunks;
+
+  // Memory counters the system provides, as rates over the interval
+  MemorySample m = memory.sample();
+  if (m.minor_faults >= 0)
+    os << ",\"minor_faults_per_s\":"
+       << (m.minor_faults - last_memory.minor_faults) / dt
+       << ",\"major_faults\":" << m.major_faults - last_memory.major_faults;
+  if (m.dtlb_misses >= 0)
+    os << ",\"dtlb_misses_per_s\":"
+       << (m.dtlb_misses - last_memory.dtlb_misses) / dt;
+  if (m.thp_bytes >= 0)
+    os << ",\"thp_bytes\":" << m.thp_bytes;
+  os << "}\n";
+  os.flush();
+  os.flags(flags);
+  os.precision(precision);
+
+  last = c;
+  last_memory = m;
+  last_time = now;
+}
+
+PhaseAccounting::PhaseAccounting()
+    : out(nullptr), report_interval(1000), sample_every(16), sampling(false),
+      phase_ns{}, sampled_ns(0), sampled_iterations(0) {}
+
+void PhaseAccounting::configure(std::ostream *o, int interval, int every) {
+  out = o;
+  report_interval = interval > 0 ? interval : 1000;
+  sample_every = every > 0 ? every : 16;
+}
+
+void PhaseAccounting::begin_iteration(uint64_t iteration) {
+  sampling = out && iteration % sample_every == 0;
+  if (sampling)
+    iteration_start = std::chrono::steady_clock::now();
+}
+
+void PhaseAccounting::end_iteration(uint64_t iteration) {
+  if (sampling) {
+    sampled_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - iteration_start)
+                      .count();
+    sampled_iterations++;
+    sampling = false;
+  }
+  if (out && (iteration + 1) % report_interval == 0)
+    report(iteration + 1);
+}
+
+void PhaseAccounting::report(uint64_t iteration) const {
+  if (!out || sampled_ns == 0)
+    return;
+
+  static const char *names[(int)TrainPhase::COUNT] = {
+      "deal", "state copy", "info set", "hash lookup", "get_strategy",
+      "terminal eval"};
+
+  std::ostream &os = *out;
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(1);
+  os << "Phase breakdown @ iteration " << iteration << " ("
+     << sampled_iterations << " sampled, " << std::setprecision(3)
+     << sampled_ns / 1e6 / sampled_iterations << " ms/iteration)\n"
+     << std::setprecision(1);
+
+  uint64_t named = 0;
+  for (int p = 0; p < (int)TrainPhase::COUNT; ++p) {
+    named += phase_ns[p];
+    os << "  " << std::left << std::setw(14) << names[p] << std::right
+       << std::setw(6) << 100.0 * phase_ns[p] / sampled_ns << "%\n";
+  }
+  uint64_t other = sampled_ns > named ? sampled_ns - named : 0;
+  os << "  " << std::left << std::setw(14) << "other" << std::right
+     << std::setw(6) << 100.0 * other / sampled_ns << "%\n";
+  os.flags(flags);
+  os.precision(precision);
+}
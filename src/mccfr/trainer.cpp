@@ -1,202 +1,457 @@
 #include "../../include/mccfr/trainer.h"
+#include "../../include/mccfr/shard.h"
+#include "../../include/mccfr/subgame_solver.h"
+#include "../../include/mccfr/warm_start.h"
+#include "../../include/profiling.h"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <random>
 #include <set>
+#include <sstream>
+
+// Optional model file sections appended after the node table:
+// u32 tag, u64 payload size, payload
+static const uint32_t SECTION_PREFLOP_CHART = 0x48434650; // "PFCH"
 
 // Removed depth limit - let CFR explore freely
 // static const int MAX_CFR_DEPTH = 50;
 
-Trainer::Trainer(GameState *g) : game(g), em(*(g->equity_module)) {}
+Trainer::Trainer(GameState *g)
+    : game(g), em(*(g->equity_module)), seeded(false), seed(0),
+      frozen_table(false), regrets_loaded(false), telemetry_out(nullptr), telemetry_interval(100),
+      resolver(nullptr), opponent_model(nullptr), warm_start(nullptr),
+      presample_runouts(false), runout_active(false), runout_players(0) {}
+
+Trainer::~Trainer() = default;
+
+// Inserts a fresh node and accounts for its memory in the telemetry
+Node *Trainer::add_node(const InfoSetKey &key, int num_actions) {
+  Node *node = arena.create(num_actions);
+  node_map[key] = node;
+  counters.node_bytes += sizeof(Node) + Node::values_size(num_actions) +
+                         sizeof(std::pair<const InfoSetKey, Node *>) +
+                         sizeof(void *) + key.capacity();
+  counters.store_bytes = arena.mapped_bytes();
+  counters.store_huge_chunks = arena.hugetlb_chunks() + arena.advised_chunks();
+  return node;
+}
 
-Trainer::~Trainer() {
-  for (auto &itr : node_map) {
-    delete itr.second;
-  }
+void Trainer::clear_nodes() {
+  node_map.clear();
+  arena.reset();
+  counters.node_bytes = counters.store_bytes = counters.store_huge_chunks = 0;
 }
 
 // Helper function to deal random hole cards
 void Trainer::deal_random_hole_cards(GameState &state, std::mt19937 &gen) {
-  // Create a full deck
-  std::vector<Card> deck;
-  for (int r = 0; r < 13; ++r) {
-    for (int s = 0; s < 4; ++s) {
-      deck.emplace_back(static_cast<Rank>(r), static_cast<Suit>(s));
-    }
-  }
+  PhaseTimer timer(phases, TrainPhase::DEAL);
 
-  // Shuffle the deck
-  std::shuffle(deck.begin(), deck.end(), gen);
+  if (runout_active) {
+    for (auto &player : state.players)
+      player.hole_cards.assign(runout_cards.begin() + 2 * player.id,
+                               runout_cards.begin() + 2 * player.id + 2);
+    return;
+  }
 
-  // Deal 2 cards to each player
-  int card_idx = 0;
+  // Deal 2 cards to each player from a fresh deck
+  Deck deck;
   for (auto &player : state.players) {
     player.hole_cards.clear();
-    player.hole_cards.push_back(deck[card_idx++]);
-    player.hole_cards.push_back(deck[card_idx++]);
+    deck.draw(gen, 2, player.hole_cards);
   }
 }
 
 // Helper function to deal random community cards
 void Trainer::deal_random_community_cards(GameState &state, int num_cards,
                                           std::mt19937 &gen) {
-  // Create a full deck
-  std::vector<Card> deck;
-  for (int r = 0; r < 13; ++r) {
-    for (int s = 0; s < 4; ++s) {
-      deck.emplace_back(static_cast<Rank>(r), static_cast<Suit>(s));
-    }
+  PhaseTimer timer(phases, TrainPhase::DEAL);
+
+  // Reveal the next cards of the presampled board
+  if (runout_active) {
+    auto board = runout_cards.begin() + 2 * runout_players;
+    size_t have = state.community_cards.size();
+    for (size_t i = have; i < have + num_cards && i < 5; ++i)
+      state.community_cards.push_back(board[i]);
+    return;
   }
 
   // Remove already dealt cards (player hole cards + existing community cards)
-  auto is_dealt = [&](const Card &c) {
-    // Check player cards
-    for (const auto &p : state.players) {
-      for (const auto &pc : p.hole_cards) {
-        if (pc.rank == c.rank && pc.suit == c.suit)
-          return true;
-      }
-    }
-    // Check existing community cards
-    for (const auto &cc : state.community_cards) {
-      if (cc.rank == c.rank && cc.suit == c.suit)
-        return true;
-    }
-    return false;
-  };
+  Deck deck;
+  for (const auto &p : state.players)
+    deck.remove(p.hole_cards);
+  deck.remove(state.community_cards);
 
-  deck.erase(std::remove_if(deck.begin(), deck.end(), is_dealt), deck.end());
+  num_cards = std::min(num_cards, deck.size());
+  deck.draw(gen, num_cards, state.community_cards);
+}
 
-  // Shuffle remaining deck
-  std::shuffle(deck.begin(), deck.end(), gen);
+void Trainer::sample_runout(int num_players, std::mt19937 &gen) {
+  {
+    PhaseTimer timer(phases, TrainPhase::DEAL);
+    Deck deck;
+    runout_cards.clear();
+    deck.draw(gen, 2 * num_players + 5, runout_cards);
+  }
 
-  // Deal the specified number of cards
-  for (int i = 0; i < num_cards && i < (int)deck.size(); ++i) {
-    state.community_cards.push_back(deck[i]);
+  PhaseTimer timer(phases, TrainPhase::TERMINAL);
+  HandMask board;
+  for (int c = 0; c < 5; ++c)
+    board.add(runout_cards[2 * num_players + c]);
+  runout_ranks.resize(num_players);
+  for (int p = 0; p < num_players; ++p) {
+    HandMask hand = board;
+    hand.add(runout_cards[2 * p]);
+    hand.add(runout_cards[2 * p + 1]);
+    runout_ranks[p] = hand.score();
   }
+  runout_players = num_players;
+  runout_active = true;
 }
 
 void Trainer::train(int iterations, int num_players) {
+  (void)num_players; // table sizes come from the abstraction
+  TrainingBudget budget;
+  budget.iterations = iterations;
+  if (iterations > 0)
+    train(budget);
+}
+
+// "1h02m", "4m12s", "37s"
+static std::string format_duration(double seconds) {
+  long long s = std::llround(std::max(seconds, 0.0));
+  std::ostringstream os;
+  if (s >= 3600)
+    os << s / 3600 << "h" << std::setw(2) << std::setfill('0')
+       << s % 3600 / 60 << "m";
+  else if (s >= 60)
+    os << s / 60 << "m" << std::setw(2) << std::setfill('0') << s % 60
+       << "s";
+  else
+    os << s << "s";
+  return os.str();
+}
+
+int64_t Trainer::train(const TrainingBudget &budget) {
   if (!game) {
-    return;
+    return 0;
   }
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-
-  // Configuration options for sampling
-  std::vector<int> player_counts = {2, 3, 4, 5, 6};
-  std::vector<double> stack_bb_options = {10, 25, 50, 100, 200};
+  std::mt19937 gen(seeded ? seed : std::random_device{}());
+  // The chart copies nodes that training is about to change
+  preflop_chart = PreflopChart();
+
+  // Table sizes and stacks to sample from
+  const std::vector<int> &player_counts = active_abstraction().player_counts;
+  const std::vector<double> &stack_bb_options = active_abstraction().stack_mix;
+
+  TelemetryEmitter telemetry(telemetry_out, counters);
+  int batch = std::max(1, budget.batch);
+  auto start = std::chrono::steady_clock::now();
+  const char *reason = "iteration limit reached";
+
+  // Latest regret_bound() scan and when it ran
+  double bound = 0;
+  int64_t bound_iteration = 0;
+  double bound_elapsed = 0;
+
+  int64_t i = 0;
+  for (;; ++i) {
+    if (i % batch == 0) {
+      double elapsed =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                        start)
+              .count();
+      double rate = elapsed > 0 ? i / elapsed : 0;
+
+      if (budget.iterations > 0 && i >= budget.iterations)
+        break;
+      if (budget.seconds > 0 && elapsed >= budget.seconds) {
+        reason = "time limit reached";
+        break;
+      }
+      if (budget.target_regret > 0 && i > 0 &&
+          (bound_iteration == 0 ||
+           elapsed - bound_elapsed >= budget.regret_check_seconds)) {
+        bound = regret_bound();
+        bound_iteration = i;
+        bound_elapsed = elapsed;
+      }
+      if (bound_iteration > 0 && bound <= budget.target_regret) {
+        reason = "regret target reached";
+        break;
+      }
+      if (budget.stop && *budget.stop) {
+        reason = "interrupted";
+        break;
+      }
 
-  for (int i = 0; i < iterations; ++i) {
+      // Remaining time of the nearest limit at the measured throughput; a
+      // regret target is extrapolated along 1/sqrt(iterations)
+      double eta = -1;
+      if (rate > 0) {
+        if (budget.iterations > 0)
+          eta = (budget.iterations - i) / rate;
+        if (budget.seconds > 0 &&
+            (eta < 0 || budget.seconds - elapsed < eta))
+          eta = budget.seconds - elapsed;
+        // From the latest scan, until the run has overtaken its estimate
+        if (budget.target_regret > 0 && bound > 0) {
+          double needed =
+              bound_iteration * std::pow(bound / budget.target_regret, 2);
+          if (needed > i && (eta < 0 || (needed - i) / rate < eta))
+            eta = (needed - i) / rate;
+        }
+      }
 
-    if (i % 100 == 0) {
-      std::cout << "Iteration " << i << "/" << iterations
-                << " — nodes=" << node_map.size() << "\n";
+      std::cout << "Iteration " << i;
+      if (budget.iterations > 0)
+        std::cout << "/" << budget.iterations;
+      std::cout << " — nodes=" << node_map.size();
+      if (rate > 0)
+        std::cout << " — " << std::fixed << std::setprecision(1) << rate
+                  << " it/s";
+      if (bound_iteration > 0)
+        std::cout << " — regret bound " << std::setprecision(4) << bound
+                  << " bb";
+      if (eta >= 0)
+        std::cout << " — ETA " << format_duration(eta);
+      std::cout << std::defaultfloat << std::setprecision(6) << "\n";
+    }
+    if (telemetry.enabled() && i > 0 && i % telemetry_interval == 0) {
+      telemetry.emit(counters, node_map.size(), node_map.bucket_count(),
+                     node_map.load_factor());
     }
 
     // Randomly sample configuration
     int sampled_players = player_counts[gen() % player_counts.size()];
     double stack_bb = stack_bb_options[gen() % stack_bb_options.size()];
 
-    sampled_players = 5;
-    // Fixed blinds (abstraction normalizes anyway)
-    double bb = 2.0;
-    double sb = 1.0;
-    double stack = stack_bb * bb;
+    // Stack in chips at the fixed 2.0 big blind used by traverse()
+    double stack = stack_bb * 2.0;
 
     // External sampling: traverse from each player's perspective
-    for (int traverser = 0; traverser < sampled_players; ++traverser) {
-      if (i == 0)
-        std::cout << "DEBUG: Starting traverser " << traverser << "\n";
-
-      GameState s(nullptr, game->equity_module);
-
-      // Proper initialization using correct constructor logic
-      s.init_game_setup(sampled_players, stack, sb, bb);
-
-      // start_hand() now works correctly
-      s.start_hand();
-      if (i == 0)
-        std::cout << "DEBUG: Dealing hole cards\n";
-      deal_random_hole_cards(s, gen);
-      if (i == 0)
-        std::cout << "DEBUG: Hole cards dealt\n";
-
-      // CFR ENTRY POINT
-      if (i == 0)
-        std::cout << "DEBUG: Calling CFR\n";
-        std::vector<double> reach(sampled_players, 1.0);
-      cfr(s, traverser,
-          1.0, // prob_traverser
-          reach, 
-          1.0, // prob_chance
-          gen, 0);
-      if (i == 0)
-        std::cout << "DEBUG: CFR returned\n";
-    }
+    phases.begin_iteration(i);
+    if (presample_runouts)
+      sample_runout(sampled_players, gen);
+    for (int traverser = 0; traverser < sampled_players; ++traverser)
+      traverse(sampled_players, stack, traverser, gen);
+    runout_active = false;
+    phases.end_iteration(i);
+    counters.iterations++;
   }
-  std::cout << "Training complete: " << iterations << " iterations\n";
+  telemetry.emit(counters, node_map.size(), node_map.bucket_count(),
+                 node_map.load_factor());
+  std::cout << "Training complete: " << i << " iterations (" << reason
+            << ")\n";
+  return i;
 }
 
-std::vector<double> Trainer::calculate_payoffs(GameState &state) {
-  int pot = state.pot_size;
-  std::vector<double> payoff(state.num_players, 0.0);
+double Trainer::regret_bound() const {
+  if (counters.iterations == 0)
+    return 0;
+  double total = 0;
+  for (auto &[key, node] : node_map)
+    total += node->get_max_regret();
+  // Chips to big blinds at the fixed 2.0 big blind used by traverse()
+  return total / counters.iterations / 2.0;
+}
 
-  int best_rank = -1;
-  std::vector<int> rank(state.num_players, -9999);
+double Trainer::traverse(int num_players, double stack, int traverser,
+                         std::mt19937 &gen) {
+  // Fixed blinds (abstraction normalizes anyway)
+  double bb = 2.0;
+  double sb = 1.0;
+
+  GameState s(nullptr, game->equity_module);
+
+  // Proper initialization using correct constructor logic
+  s.init_game_setup(num_players, stack, sb, bb);
+
+  // start_hand() now works correctly
+  s.start_hand();
+  deal_random_hole_cards(s, gen);
+
+  // CFR ENTRY POINT
+  double reach[MAX_SEATS];
+  std::fill(reach, reach + num_players, 1.0);
+  return cfr(s, traverser,
+             1.0, // prob_traverser
+             reach,
+             1.0, // prob_chance
+             gen, 0);
+}
 
-  for (int i = 0; i < state.num_players; ++i) {
-    Player *p = state.get_player(i);
+void Trainer::settle(const GameState &state, const int *ranks,
+                     double *payoff) {
+  int n = std::min(state.num_players, MAX_SEATS);
+  double contrib[MAX_SEATS];
+  bool folded[MAX_SEATS];
+  int rank[MAX_SEATS];
+
+  int live = 0;
+  for (int i = 0; i < n; ++i) {
+    const Player &p = state.players[i];
+    contrib[i] = p.total_bet_size;
+    folded[i] = p.is_folded;
+    rank[i] = 0;
+    live += !p.is_folded;
+  }
 
-    if (p->is_folded) {
-      payoff[i] = -p->total_bet_size;
-      continue;
+  // Only a contested pot needs hand ranks. The board is summarized once and
+  // every live hole-card pair is added to a copy of it.
+  if (live > 1) {
+    if (ranks) {
+      std::copy(ranks, ranks + n, rank);
+    } else {
+      HandMask board;
+      for (const auto &c : state.community_cards)
+        board.add(c);
+      for (int i = 0; i < n; ++i) {
+        if (folded[i])
+          continue;
+        HandMask hand = board;
+        for (const auto &c : state.players[i].hole_cards)
+          hand.add(c);
+        rank[i] = hand.score();
+      }
     }
+  }
+
+  settle_pots(n, contrib, folded, rank, payoff);
+}
+
+void Trainer::calculate_payoffs(GameState &state, double *payoff) {
+  PhaseTimer timer(phases, TrainPhase::TERMINAL);
+  // Showdown on the presampled board is an integer compare
+  settle(state, runout_active ? runout_ranks.data() : nullptr, payoff);
+}
 
-    std::vector<Card> hand;
-    hand.insert(hand.end(), p->hole_cards.begin(), p->hole_cards.end());
-    hand.insert(hand.end(), state.community_cards.begin(),
-                state.community_cards.end());
+double Trainer::get_terminal_payoff(GameState &state, int player_id) {
+  double payoff[MAX_SEATS];
+  calculate_payoffs(state, payoff);
+  return payoff[player_id];
+}
 
-    rank[i] = em.evaluate_7_cards(hand);
-    best_rank = std::max(best_rank, rank[i]);
+//
+// ----------------------------------------------
+// All-in runouts
+// ----------------------------------------------
+//
+
+bool Trainer::is_allin_runout(const GameState &state) {
+  int live = 0, can_act = 0;
+  for (const auto &p : state.players) {
+    if (p.is_folded)
+      continue;
+    live++;
+    can_act += !p.is_all_in;
   }
+  return live >= 2 && can_act <= 1;
+}
 
-  for (int i = 0; i < state.num_players; ++i) {
-    Player *p = state.get_player(i);
+double Trainer::allin_runout_payoff(GameState &state, int player_id,
+                                    std::mt19937 &gen) {
+  // The shared runout of this iteration is already fixed
+  if (runout_active)
+    return get_terminal_payoff(state, player_id);
+
+  PhaseTimer timer(phases, TrainPhase::TERMINAL);
+
+  int n = std::min(state.num_players, MAX_SEATS);
+  double contrib[MAX_SEATS], payoff[MAX_SEATS];
+  bool folded[MAX_SEATS];
+  int rank[MAX_SEATS];
+
+  // Every dealt card is dead, folded hands included
+  Deck deck;
+  deck.remove(state.community_cards);
+  HandMask board;
+  for (const auto &c : state.community_cards)
+    board.add(c);
+
+  HandMask hands[MAX_SEATS];
+  for (int i = 0; i < n; ++i) {
+    const Player &p = state.players[i];
+    contrib[i] = p.total_bet_size;
+    folded[i] = p.is_folded;
+    rank[i] = 0;
+    deck.remove(p.hole_cards);
+    hands[i] = board;
+    for (const auto &c : p.hole_cards)
+      hands[i].add(c);
+  }
 
-    if (p->is_folded) {
-      // already set: payoff[i] = -p->current_bet;
-    } else if (rank[i] == best_rank) {
-      payoff[i] = pot - p->total_bet_size;
-    } else {
-      payoff[i] = -p->total_bet_size;
+  int to_come = std::max(0, 5 - (int)state.community_cards.size());
+
+  // Settles one completed board (runout = extra cards on top of `board`)
+  auto settle = [&](const int *runout) {
+    for (int i = 0; i < n; ++i) {
+      if (folded[i])
+        continue;
+      HandMask h = hands[i];
+      for (int c = 0; c < to_come; ++c)
+        h.add(Deck::card(runout[c]));
+      rank[i] = h.score();
     }
-  }
+    settle_pots(n, contrib, folded, rank, payoff);
+    return payoff[player_id];
+  };
 
-  return payoff;
-}
+  int runout[5];
+  double total = 0.0;
+  if (to_come <= 1) {
+    if (to_come == 0)
+      return settle(runout);
+    int runouts = 0;
+    for (int c = 0; c < Deck::SIZE; ++c) {
+      if (!deck.contains(Deck::card(c)))
+        continue;
+      runout[0] = c;
+      total += settle(runout);
+      runouts++;
+    }
+    return runouts > 0 ? total / runouts : 0.0;
+  }
 
-double Trainer::get_terminal_payoff(GameState &state, int player_id) {
-  return calculate_payoffs(state)[player_id];
+  // Too many runouts to enumerate: fresh samples on every call, so repeated
+  // visits average out instead of sharing one fixed estimate
+  for (int s = 0; s < ALLIN_SAMPLES; ++s) {
+    Deck d = deck;
+    for (int c = 0; c < to_come; ++c)
+      runout[c] = d.draw_index(gen);
+    total += settle(runout);
+  }
+  return total / ALLIN_SAMPLES;
 }
 
 double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
-                    std::vector<double> &reach, double prob_chance, std::mt19937 &gen,
+                    const double *reach, double prob_chance, std::mt19937 &gen,
                     int depth) {
+  counters.nodes_visited++;
+
   //
   // Terminal check
   //
-  if (state.is_terminal() || depth > 200)
+  if (state.is_terminal() || depth > 200) {
+    counters.terminal_evals++;
+    counters.terminal_depth_sum += depth;
     return get_terminal_payoff(state, traverser);
+  }
 
   //
   // STREET TRANSITION 
   //
   if (state.is_betting_round_over() && state.stage != Stage::SHOWDOWN) {
+    if (is_allin_runout(state)) {
+      counters.terminal_evals++;
+      counters.terminal_depth_sum += depth;
+      return allin_runout_payoff(state, traverser, gen);
+    }
+
     if (state.stage == Stage::PREFLOP && state.community_cards.empty()) {
       deal_random_community_cards(state, 3, gen);
       // state.stage = Stage::FLOP;
@@ -216,8 +471,11 @@ double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
     }
     state.next_street();
 
-    if (state.is_terminal())
+    if (state.is_terminal()) {
+      counters.terminal_evals++;
+      counters.terminal_depth_sum += depth;
       return get_terminal_payoff(state, traverser);
+    }
   }
 
   Player *curr = state.get_current_player();
@@ -227,25 +485,52 @@ double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
   int acting = curr->id;
 
   //
-  // Build info set (your GameState no longer appends legal-action count)
+  // Legal actions according to your NEW abstraction system, computed once
+  // for the key, the strategy size and the children
   //
-  std::string info = state.compute_information_set(acting);
+  ActionList legal = state.get_legal_actions();
+  if (legal.empty()) {
+    counters.terminal_evals++;
+    counters.terminal_depth_sum += depth;
+    return get_terminal_payoff(state, traverser);
+  }
+  int num_actions = legal.size();
 
   //
-  // Legal actions according to your NEW abstraction system
+  // Build info set
   //
-  auto legal = state.get_legal_actions();
-  if (legal.empty())
-    return get_terminal_payoff(state, traverser);
+  std::string info;
+  {
+    PhaseTimer timer(phases, TrainPhase::INFOSET);
+    info = state.compute_information_set(acting, num_actions);
+  }
 
   //
   // Node lookup
   //
-  if (node_map.count(info) <= 0)
-    node_map[info] = new Node(legal.size());
+  Node *node;
+  {
+    PhaseTimer timer(phases, TrainPhase::LOOKUP);
+    auto found = node_map.find(info);
+    if (found == node_map.end()) {
+      node = add_node(info, num_actions);
+      int street = std::clamp((int)state.stage - (int)Stage::PREFLOP, 0, 3);
+      counters.new_infosets[street]++;
+      if (warm_start)
+        warm_start->seed(node, state, acting, legal, info);
+    } else {
+      node = found->second;
+    }
+  }
+  double strategy[MAX_ACTIONS];
+  {
+    PhaseTimer timer(phases, TrainPhase::STRATEGY);
+    node->get_strategy(reach[acting], strategy);
+  }
 
-  Node *node = node_map[info];
-  std::vector<double> strategy = node->get_strategy(reach[curr->id]);
+  int n = state.num_players;
+  double next_reach[MAX_SEATS];
+  std::copy(reach, reach + n, next_reach);
 
   //
   // -----------------------------------------------------
@@ -255,14 +540,13 @@ double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
   if (acting == traverser) {
 
     double node_util = 0.0;
-    std::vector<double> utils(legal.size());
+    double utils[MAX_ACTIONS];
 
-    for (size_t i = 0; i < legal.size(); ++i) {
-      GameState next = state;
+    for (int i = 0; i < num_actions; ++i) {
+      GameState next = copy_state(state);
       next.apply_action(legal[i], true);
 
-      std::vector<double> next_reach = reach;
-      next_reach[traverser] *= strategy[i];
+      next_reach[traverser] = reach[traverser] * strategy[i];
 
       utils[i] = cfr(next, traverser, prob_traverser * strategy[i],
                      next_reach, prob_chance, gen, depth + 1);
@@ -275,14 +559,13 @@ double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
     //
     double scale = prob_chance;
 
-    for (size_t p = 0; p < reach.size(); ++p) {
-      if ((int) p != traverser) {
+    for (int p = 0; p < n; ++p) {
+      if (p != traverser) {
         scale *= reach[p];
-      }   
+      }
     }
-            
 
-    for (size_t i = 0; i < legal.size(); ++i) {
+    for (int i = 0; i < num_actions; ++i) {
       double regret = (utils[i] - node_util) * scale;
       node->update_regret_sum(i, regret);
     }
@@ -295,13 +578,14 @@ double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
   //     OPPONENT — SAMPLE ONE ACTION only
   // -----------------------------------------------------
   //
-  std::discrete_distribution<> dist(strategy.begin(), strategy.end());
-  int a = dist(gen);
+  double r = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+  int a = 0;
+  for (double cum = strategy[0]; a < num_actions - 1 && r >= cum;)
+    cum += strategy[++a];
 
-  GameState next = state;
+  GameState next = copy_state(state);
   next.apply_action(legal[a], true);
 
-  std::vector<double> next_reach = reach;
   next_reach[acting] *= strategy[a];
 
   return cfr(next, traverser, prob_traverser, next_reach,
@@ -315,11 +599,115 @@ double Trainer::cfr(GameState &state, int traverser, double prob_traverser,
 //
 
 std::vector<double> Trainer::get_strategy(const std::string &info) {
-  if (node_map.count(info) > 0)
-    return node_map[info]->get_average_strategy();
+  PROFILE_STAGE(ProfileStage::NODE_LOOKUP);
+  if (frozen_table) {
+    const FrozenIndex::Entry *e = frozen.find(info);
+    if (!e)
+      return {};
+    std::vector<double> probs(e->num_actions);
+    FrozenIndex::write_strategy(*e, probs.data());
+    return probs;
+  }
+  auto it = node_map.find(info);
+  if (it != node_map.end())
+    return it->second->get_average_strategy();
   return {};
 }
 
+void Trainer::get_strategies(std::span<const InfoSetKey> keys,
+                             std::span<double> probs,
+                             std::span<int> num_actions) const {
+  PROFILE_STAGE(ProfileStage::NODE_LOOKUP);
+  // Lookups run a window ahead of the reads so the cache misses of
+  // consecutive keys overlap instead of serializing
+  const size_t WINDOW = 16;
+  const Node *window[WINDOW];
+  size_t buckets[WINDOW];
+  decltype(node_map)::const_local_iterator heads[WINDOW];
+
+  if (frozen_table && frozen.empty()) {
+    std::fill(num_actions.begin(), num_actions.begin() + keys.size(), 0);
+    return;
+  }
+  if (frozen_table) {
+    // Same overlap in three stages: pilots, then entries, then reads
+    uint64_t hashes[WINDOW];
+    const FrozenIndex::Entry *entries[WINDOW];
+    for (size_t base = 0; base < keys.size(); base += WINDOW) {
+      size_t n = std::min(WINDOW, keys.size() - base);
+      for (size_t i = 0; i < n; ++i) {
+        hashes[i] = frozen.hash(keys[base + i]);
+        frozen.prefetch(hashes[i]);
+      }
+      for (size_t i = 0; i < n; ++i) {
+        entries[i] = &frozen.candidate(hashes[i]);
+        __builtin_prefetch(entries[i]);
+      }
+      for (size_t i = 0; i < n; ++i) {
+        size_t row = base + i;
+        num_actions[row] =
+            FrozenIndex::matches(*entries[i], hashes[i])
+                ? FrozenIndex::write_strategy(*entries[i],
+                                              &probs[row * MAX_ACTIONS])
+                : 0;
+      }
+    }
+    return;
+  }
+
+  for (size_t base = 0; base < keys.size(); base += WINDOW) {
+    size_t n = std::min(WINDOW, keys.size() - base);
+
+    // Hash the whole window and load its bucket heads first: independent
+    // loads, so their misses overlap before the dependent bucket walks
+    for (size_t i = 0; i < n; ++i) {
+      buckets[i] = node_map.bucket(keys[base + i]);
+      heads[i] = node_map.begin(buckets[i]);
+      if (heads[i] != node_map.end(buckets[i]))
+        __builtin_prefetch(&*heads[i]);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      window[i] = nullptr;
+      for (auto it = heads[i]; it != node_map.end(buckets[i]); ++it)
+        if (it->first == keys[base + i]) {
+          window[i] = it->second;
+          window[i]->prefetch();
+          break;
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      size_t row = base + i;
+      num_actions[row] =
+          window[i] ? window[i]->write_average_strategy(&probs[row * MAX_ACTIONS])
+                    : 0;
+    }
+  }
+}
+
+void Trainer::get_strategies(std::span<GameState> states,
+                             std::span<double> probs,
+                             std::span<int> num_actions) const {
+  // Reused across calls; an empty key marks a state nobody acts in
+  static thread_local std::vector<InfoSetKey> keys;
+  keys.resize(states.size());
+  for (size_t i = 0; i < states.size(); ++i) {
+    GameState &s = states[i];
+    bool acting = !s.is_terminal() && s.current_player_index >= 0 &&
+                  s.current_player_index < (int)s.players.size();
+    if (acting)
+      keys[i] = s.compute_information_set(s.get_current_player()->id);
+    else
+      keys[i].clear();
+  }
+  get_strategies(std::span<const InfoSetKey>(keys.data(), states.size()),
+                 probs, num_actions);
+  for (size_t i = 0; i < states.size(); ++i)
+    if (keys[i].empty())
+      num_actions[i] = 0;
+}
+
 //
 // ----------------------------------------------
 // Action recommendation
@@ -328,7 +716,15 @@ std::vector<double> Trainer::get_strategy(const std::string &info) {
 
 Action Trainer::get_action_recommendation(GameState &state, int player_id,
                                           std::vector<double> &probs) {
-  std::string info = state.compute_information_set(player_id);
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  return get_action_recommendation(state, player_id, probs, gen);
+}
+
+Action Trainer::get_action_recommendation(GameState &state, int player_id,
+                                          std::vector<double> &probs,
+                                          std::mt19937 &gen) {
+  PROFILE_STAGE(ProfileStage::DECISION);
   auto legal = state.get_legal_actions();
 
   if (legal.empty()) {
@@ -336,12 +732,25 @@ Action Trainer::get_action_recommendation(GameState &state, int player_id,
     return Action(-1, ActionType::FOLD, 0);
   }
 
-  probs = get_strategy(info);
-  if (probs.empty())
+  probs.clear();
+  if (resolver)
+    probs = resolver->solve(state, player_id);
+  // The chart holds the same nodes as the table for the first preflop
+  // decisions, without building the info-set key
+  if (probs.size() != legal.size()) {
+    const PreflopChart::Entry *e = preflop_chart.lookup(state, player_id, legal);
+    if (e)
+      probs.assign(e->probs, e->probs + e->num_actions);
+  }
+  if (probs.size() != legal.size())
+    probs = get_strategy(state.compute_information_set(player_id));
+  if (probs.size() != legal.size())
     probs.assign(legal.size(), 1.0 / legal.size());
+  if (opponent_model) {
+    PROFILE_STAGE(ProfileStage::EXPLOIT);
+    opponent_model->adjust(state, player_id, legal, probs);
+  }
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
   std::discrete_distribution<> dist(probs.begin(), probs.end());
   int idx = dist(gen) % legal.size();
   return legal[idx];
@@ -354,6 +763,10 @@ Action Trainer::get_action_recommendation(GameState &state, int player_id,
 //
 
 void Trainer::save_to_file(const std::string &fn) {
+  if (frozen_table) {
+    std::cerr << "Cannot save a frozen model to " << fn << "\n";
+    return;
+  }
   std::ofstream out(fn, std::ios::binary);
   if (!out) {
     std::cerr << "Cannot write file " << fn << "\n";
@@ -373,21 +786,63 @@ void Trainer::save_to_file(const std::string &fn) {
     out.write((char *)&k, sizeof(k));
     out.write((char *)sum.data(), sizeof(double) * k);
   }
+
+  active_abstraction().write_section(out);
+
+  // Same iteration order as the table above
+  uint64_t regret_bytes = sizeof(uint64_t);
+  for (auto &[key, node] : node_map)
+    regret_bytes += sizeof(double) * node->get_num_actions();
+  uint64_t count = N;
+  out.write((char *)&SECTION_REGRETS, sizeof(SECTION_REGRETS));
+  out.write((char *)&regret_bytes, sizeof(regret_bytes));
+  out.write((char *)&count, sizeof(count));
+  for (auto &[key, node] : node_map) {
+    auto regrets = node->get_regret_sum();
+    out.write((char *)regrets.data(), sizeof(double) * regrets.size());
+  }
+
+  if (!preflop_chart.empty()) {
+    std::stringstream payload;
+    preflop_chart.write(payload);
+    std::string bytes = payload.str();
+    uint64_t size = bytes.size();
+    out.write((char *)&SECTION_PREFLOP_CHART, sizeof(SECTION_PREFLOP_CHART));
+    out.write((char *)&size, sizeof(size));
+    out.write(bytes.data(), size);
+  }
 }
 
 void Trainer::load_from_file(const std::string &fn) {
+  AbstractionConfig abstraction;
+  if (!read_model(fn, abstraction))
+    return;
+
+  // Only worth a note when a non-standard abstraction was asked for
+  const AbstractionConfig &requested = active_abstraction();
+  if (!requested.same_abstraction(AbstractionConfig::standard()) &&
+      !requested.same_abstraction(abstraction))
+    std::cerr << "Using the abstraction stored in " << fn << "\n";
+  set_active_abstraction(abstraction);
+}
+
+bool Trainer::read_model(const std::string &fn,
+                         AbstractionConfig &abstraction) {
   std::ifstream in(fn, std::ios::binary);
   if (!in) {
     std::cerr << "Cannot open file " << fn << "\n";
-    return;
+    return false;
   }
 
-  for (auto &[k, n] : node_map)
-    delete n;
-  node_map.clear();
+  clear_nodes();
+  frozen = FrozenIndex();
+  frozen_table = false;
+  regrets_loaded = false;
 
   size_t N;
   in.read((char *)&N, sizeof(N));
+  std::vector<Node *> order;
+  order.reserve(N);
 
   for (size_t i = 0; i < N; ++i) {
     size_t len;
@@ -402,9 +857,140 @@ void Trainer::load_from_file(const std::string &fn) {
     std::vector<double> sum(k);
     in.read((char *)sum.data(), sizeof(double) * k);
 
-    Node *node = new Node(k);
+    Node *node = add_node(key, k);
     node->set_strategy_sum(sum);
+    order.push_back(node);
+  }
 
-    node_map[key] = node;
+  // Trailing sections; older models simply end here. Models without an
+  // abstraction section were built with the standard one, models without
+  // regrets resume from zero regrets.
+  preflop_chart = PreflopChart();
+  abstraction = AbstractionConfig::standard();
+  uint32_t tag;
+  uint64_t size;
+  while (in.read((char *)&tag, sizeof(tag)) &&
+         in.read((char *)&size, sizeof(size))) {
+    std::streampos end = in.tellg() + (std::streamoff)size;
+    if (tag == SECTION_PREFLOP_CHART && !preflop_chart.read(in))
+      std::cerr << "Ignoring unreadable preflop chart in " << fn << "\n";
+    if (tag == AbstractionConfig::SECTION_TAG) {
+      std::string text(size, '\0');
+      in.read(&text[0], size);
+      std::istringstream payload(text);
+      if (!abstraction.read(payload, fn))
+        abstraction = active_abstraction();
+    }
+    uint64_t count;
+    if (tag == SECTION_REGRETS && in.read((char *)&count, sizeof(count)) &&
+        count == order.size()) {
+      std::vector<double> regrets;
+      for (Node *node : order) {
+        regrets.resize(node->get_num_actions());
+        in.read((char *)regrets.data(), sizeof(double) * regrets.size());
+        node->set_regret_sum(regrets);
+      }
+      regrets_loaded = true;
+    }
+    in.clear();
+    in.seekg(end);
   }
-}
\ No newline at end of file
+  return true;
+}
+
+void Trainer::freeze() {
+  if (frozen_table)
+    return;
+  if (!frozen.build(node_map)) {
+    std::cerr << "Cannot build a perfect hash over " << node_map.size()
+              << " info sets; keeping the node table\n";
+    return;
+  }
+  clear_nodes();
+  node_map.rehash(0);
+  counters.node_bytes = frozen.index_bytes() + frozen.entry_bytes();
+  frozen_table = true;
+}
+
+void Trainer::build_preflop_chart() {
+  preflop_chart.build(*this, game->equity_module);
+}
+void Trainer::set_telemetry(std::ostream *out, int interval) {
+  telemetry_out = out;
+  telemetry_interval = interval > 0 ? interval : 100;
+}
+
+void Trainer::set_phase_report(std::ostream *out, int interval) {
+  phases.configure(out, interval);
+}
+
+void Trainer::set_seed(unsigned s) {
+  seed = s;
+  seeded = true;
+}
+
+//
+// ----------------------------------------------
+// Sharded training tables
+// ----------------------------------------------
+//
+
+bool Trainer::load_table(const std::string &fn) {
+  TableReader reader(fn);
+  if (!reader.is_open()) {
+    std::cerr << "Cannot open table " << fn << "\n";
+    return false;
+  }
+
+  clear_nodes();
+  frozen = FrozenIndex();
+  frozen_table = false;
+
+  for (; reader.ok(); reader.next()) {
+    TableRecord &rec = reader.record;
+    Node *node = add_node(rec.key, rec.regret_sum.size());
+    node->set_regret_sum(rec.regret_sum);
+    node->set_strategy_sum(rec.strategy_sum);
+  }
+
+  return true;
+}
+
+bool Trainer::save_table_delta(const std::string &base_fn,
+                               const std::string &fn) {
+  std::vector<std::pair<const InfoSetKey *, Node *>> sorted;
+  sorted.reserve(node_map.size());
+  for (auto &[key, node] : node_map)
+    sorted.emplace_back(&key, node);
+  std::sort(sorted.begin(), sorted.end(),
+            [](const auto &a, const auto &b) { return *a.first < *b.first; });
+
+  TableWriter writer(fn);
+  if (!writer.ok()) {
+    std::cerr << "Cannot write table " << fn << "\n";
+    return false;
+  }
+
+  // Walk the (sorted) base table alongside our keys and subtract it
+  TableReader base(base_fn);
+
+  for (auto &[key, node] : sorted) {
+    std::vector<double> regrets = node->get_regret_sum();
+    std::vector<double> sums = node->get_strategy_sum();
+
+    while (base.ok() && base.record.key < *key)
+      base.next();
+
+    if (base.ok() && base.record.key == *key) {
+      for (size_t a = 0; a < regrets.size() && a < base.record.regret_sum.size();
+           ++a) {
+        regrets[a] -= base.record.regret_sum[a];
+        sums[a] -= base.record.strategy_sum[a];
+      }
+    }
+
+    writer.write(*key, regrets, sums);
+  }
+
+  return writer.close();
+}
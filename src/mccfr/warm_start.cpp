@@ -0,0 +1,89 @@
+#include "../../include/mccfr/warm_start.h"
+#include <cmath>
+#include <limits>
+
+WarmStart::WarmStart(GameState *game, const WarmStartConfig &c)
+    : source(game), cfg(c), exact(0), mapped(0), missed(0) {}
+
+bool WarmStart::load(const std::string &filename) {
+  return source.read_model(filename, abstraction);
+}
+
+static bool is_aggressive(ActionType t) {
+  return t == ActionType::BET || t == ActionType::RAISE ||
+         t == ActionType::ALLIN;
+}
+
+// Index of the closest action in `old` (-1 when nothing comparable): same
+// type first, sizes compared on a log scale; bets and raises without a
+// sized counterpart fall back to the closest aggressive action
+static int nearest_action(const Action &a, const ActionList &old,
+                          double &distance) {
+  int best = -1;
+  distance = std::numeric_limits<double>::infinity();
+  for (size_t j = 0; j < old.size(); ++j) {
+    Action o = old[j];
+    double d;
+    if (o.type == a.type)
+      d = 0.0;
+    else if (is_aggressive(a.type) && is_aggressive(o.type))
+      d = 1.0;
+    else
+      continue;
+    if (is_aggressive(a.type))
+      d += std::abs(std::log(std::max(a.amount, 1e-9) /
+                             std::max(o.amount, 1e-9)));
+    if (d < distance) {
+      distance = d;
+      best = (int)j;
+    }
+  }
+  return best;
+}
+
+bool WarmStart::seed(Node *node, GameState &state, int player,
+                     const ActionList &legal, const std::string &info) {
+  ActionList old_legal = state.get_legal_actions(abstraction);
+  std::string key = info.substr(0, info.find('|') + 1) +
+                    state.compute_public_key(player, old_legal.size(),
+                                             abstraction);
+
+  auto found = source.node_map.find(key);
+  if (found == source.node_map.end() ||
+      found->second->get_num_actions() != (int)old_legal.size()) {
+    missed++;
+    return false;
+  }
+
+  int n = legal.size();
+  int target[Trainer::MAX_ACTIONS];
+  int shares[Trainer::MAX_ACTIONS] = {};
+  bool identical = key == info && legal.size() == old_legal.size();
+  for (int i = 0; i < n; ++i) {
+    double distance;
+    target[i] = nearest_action(legal[i], old_legal, distance);
+    if (target[i] < 0) {
+      missed++;
+      return false;
+    }
+    shares[target[i]]++;
+    identical = identical && target[i] == i && distance < 1e-9;
+  }
+
+  // Per-node scale: full weight for an unchanged node, less when its key or
+  // actions were approximated
+  double scale = cfg.weight * (identical ? 1.0 : cfg.mapped_weight);
+  std::vector<double> old_regrets = found->second->get_regret_sum();
+  std::vector<double> old_sums = found->second->get_strategy_sum();
+  std::vector<double> regrets(n), sums(n);
+  for (int i = 0; i < n; ++i) {
+    double share = scale / shares[target[i]];
+    regrets[i] = old_regrets[target[i]] * share;
+    sums[i] = old_sums[target[i]] * share;
+  }
+  node->set_regret_sum(regrets);
+  node->set_strategy_sum(sums);
+
+  (identical ? exact : mapped)++;
+  return true;
+}
@@ -0,0 +1,125 @@
+#include "../include/profiling.h"
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+static const uint64_t NO_MIN = std::numeric_limits<uint64_t>::max();
+
+StageHistogram::StageHistogram() { reset(); }
+
+void StageHistogram::reset() {
+  for (auto &b : buckets)
+    b.store(0, std::memory_order_relaxed);
+  total.store(0, std::memory_order_relaxed);
+  min_ns.store(NO_MIN, std::memory_order_relaxed);
+  max_ns.store(0, std::memory_order_relaxed);
+}
+
+int StageHistogram::bucket_of(uint64_t ns) {
+  if (ns < (uint64_t)SUB_BUCKETS)
+    return (int)ns;
+  int msb = 63 - std::countl_zero(ns);
+  int sub = (int)((ns >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+  return (msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t StageHistogram::bucket_upper(int idx) {
+  if (idx < SUB_BUCKETS)
+    return (uint64_t)idx;
+  int msb = idx / SUB_BUCKETS + SUB_BITS - 1;
+  uint64_t sub = idx % SUB_BUCKETS;
+  uint64_t lower = (1ull << msb) | (sub << (msb - SUB_BITS));
+  return lower + (1ull << (msb - SUB_BITS)) - 1;
+}
+
+void StageHistogram::record(uint64_t ns) {
+  buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+  total.fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t cur = min_ns.load(std::memory_order_relaxed);
+  while (ns < cur &&
+         !min_ns.compare_exchange_weak(cur, ns, std::memory_order_relaxed))
+    ;
+  cur = max_ns.load(std::memory_order_relaxed);
+  while (ns > cur &&
+         !max_ns.compare_exchange_weak(cur, ns, std::memory_order_relaxed))
+    ;
+}
+
+uint64_t StageHistogram::min() const {
+  uint64_t m = min_ns.load(std::memory_order_relaxed);
+  return m == NO_MIN ? 0 : m;
+}
+
+uint64_t StageHistogram::percentile(double p) const {
+  uint64_t n = count();
+  if (n == 0)
+    return 0;
+
+  // Nearest rank, same convention as LatencyRecorder
+  uint64_t rank = (uint64_t)std::ceil(p / 100.0 * n);
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t seen = 0;
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    seen += buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return std::min(bucket_upper(i), max());
+  }
+  return max();
+}
+
+StageProfiler &StageProfiler::instance() {
+  static StageProfiler profiler;
+  return profiler;
+}
+
+void StageProfiler::reset() {
+  for (auto &s : stages)
+    s.reset();
+}
+
+const char *StageProfiler::stage_name(ProfileStage stage) {
+  switch (stage) {
+  case ProfileStage::DECISION:
+    return "decision";
+  case ProfileStage::EQUITY:
+    return "equity";
+  case ProfileStage::INFOSET:
+    return "infoset";
+  case ProfileStage::LEGAL_ACTIONS:
+    return "legal_actions";
+  case ProfileStage::NODE_LOOKUP:
+    return "node_lookup";
+  case ProfileStage::EXPLOIT:
+    return "exploit";
+  default:
+    return "unknown";
+  }
+}
+
+void StageProfiler::write_json(std::ostream &os) const {
+#ifdef POKERBOT_PROFILE
+  const bool enabled = true;
+#else
+  const bool enabled = false;
+#endif
+
+  auto us = [](uint64_t ns) { return ns / 1000.0; };
+  std::ios::fmtflags flags = os.flags();
+  os << std::fixed << std::setprecision(3);
+  os << "{\"enabled\":" << (enabled ? "true" : "false") << ",\"stages\":{";
+  for (int i = 0; i < (int)ProfileStage::COUNT; ++i) {
+    const StageHistogram &h = stages[i];
+    if (i > 0)
+      os << ",";
+    os << "\"" << stage_name((ProfileStage)i) << "\":{"
+       << "\"count\":" << h.count() << ",\"min_us\":" << us(h.min())
+       << ",\"p50_us\":" << us(h.percentile(50))
+       << ",\"p99_us\":" << us(h.percentile(99))
+       << ",\"max_us\":" << us(h.max()) << "}";
+  }
+  os << "}}\n";
+  os.flags(flags);
+}
@@ -1,90 +1,219 @@
 #include "../include/risk_profiler.h"
+#include <bit>
 #include <iomanip>
-#include <iostream>
+#include <mutex>
 #include <sstream>
 
-RiskProfiler::RiskProfiler() {
-  // Constructor
+// AF is reported capped at 10 when there are bets but no calls
+static const double MAX_AF = 10.0;
+
+static double ratio(double num, double den) { return den > 0 ? num / den : 0; }
+
+static double aggression(double bets, double calls) {
+  if (calls > 0)
+    return bets / calls;
+  return bets > 0 ? MAX_AF : 0;
 }
 
-void RiskProfiler::add_player(int player_id, double initial_stack) {
-  PlayerProfile profile;
-  profile.hands_played = 0;
-  profile.hands_voluntarily_entered = 0;
-  profile.hands_raised_preflop = 0;
-  profile.total_bets = 0;
-  profile.total_calls = 0;
-  profile.stack_size = initial_stack;
-
-  player_profiles[player_id] = profile;
+RiskProfiler::RiskProfiler() {}
+
+RiskProfiler::Seat *RiskProfiler::seat(int player_id) {
+  return player_id >= 0 && player_id < MAX_SEATS ? &seats[player_id] : nullptr;
 }
 
-void RiskProfiler::update_player_profile(int player_id,
-                                         const std::string &action,
-                                         double bet_amount,
-                                         double /*pot_size*/) {
-  if (player_profiles.find(player_id) == player_profiles.end())
-    return;
+const RiskProfiler::Seat *RiskProfiler::seat(int player_id) const {
+  return player_id >= 0 && player_id < MAX_SEATS ? &seats[player_id] : nullptr;
+}
 
-  PlayerProfile &profile = player_profiles[player_id];
+void RiskProfiler::add_player(int player_id, double initial_stack) {
+  Seat *s = seat(player_id);
+  if (!s)
+    return;
+  std::lock_guard<SpinLock> guard(s->lock);
+  s->stats = SeatStats();
+  s->stats.present = true;
+  s->stats.lifetime.stack_size = initial_stack;
+}
 
-  // Update stack
-  if (bet_amount > 0) {
-    profile.stack_size -= bet_amount;
+void RiskProfiler::update_player_profile(int player_id, ProfileAction action,
+                                         double bet_amount, bool preflop,
+                                         int preflop_raises) {
+  Seat *s = seat(player_id);
+  if (!s)
+    return;
+  std::lock_guard<SpinLock> guard(s->lock);
+  SeatStats &st = s->stats;
+  if (!st.present)
+    return;
+  PlayerProfile &p = st.lifetime;
+
+  if (bet_amount > 0)
+    p.stack_size -= bet_amount;
+
+  bool raise = action == ProfileAction::BET || action == ProfileAction::RAISE ||
+               action == ProfileAction::ALLIN;
+  if (!preflop) {
+    if (raise) {
+      p.total_bets++;
+      st.hand_bets += st.hand_bets < UINT8_MAX;
+    } else if (action == ProfileAction::CALL) {
+      p.total_calls++;
+      st.hand_calls += st.hand_calls < UINT8_MAX;
+    }
+    return;
   }
 
-  // Update stats
-  if (action == "bet" || action == "raise" || action == "allin") {
-    profile.total_bets++;
-    // Note: In a real system we'd check street for PFR/VPIP more carefully
-    // For now, we rely on the caller to update hands_voluntarily_entered etc.
-  } else if (action == "call") {
-    profile.total_calls++;
+  // Each preflop stat counts a hand once, however many actions it takes
+  if ((raise || action == ProfileAction::CALL) && !(st.hand_flags & VPIP)) {
+    st.hand_flags |= VPIP;
+    p.hands_voluntarily_entered++;
   }
+  if (raise && !(st.hand_flags & PFR)) {
+    st.hand_flags |= PFR;
+    p.hands_raised_preflop++;
+  }
+  // First time facing exactly one raise: a chance to 3-bet
+  if (preflop_raises == 1 && !(st.hand_flags & THREE_BET_CHANCE)) {
+    st.hand_flags |= THREE_BET_CHANCE;
+    p.three_bet_chances++;
+    if (raise) {
+      st.hand_flags |= THREE_BET;
+      p.three_bets++;
+    }
+  }
+}
+
+void merge_profile(PlayerProfile &into, const PlayerProfile &from) {
+  into.hands_played += from.hands_played;
+  into.hands_voluntarily_entered += from.hands_voluntarily_entered;
+  into.hands_raised_preflop += from.hands_raised_preflop;
+  into.three_bet_chances += from.three_bet_chances;
+  into.three_bets += from.three_bets;
+  into.total_bets += from.total_bets;
+  into.total_calls += from.total_calls;
+}
+
+void RiskProfiler::merge_player_profile(int player_id,
+                                        const PlayerProfile &history) {
+  Seat *s = seat(player_id);
+  if (!s)
+    return;
+  std::lock_guard<SpinLock> guard(s->lock);
+  if (s->stats.present)
+    merge_profile(s->stats.lifetime, history);
 }
 
 void RiskProfiler::update_stack(int player_id, double amount) {
-  if (player_profiles.find(player_id) != player_profiles.end()) {
-    player_profiles[player_id].stack_size = amount;
-  }
+  Seat *s = seat(player_id);
+  if (!s)
+    return;
+  std::lock_guard<SpinLock> guard(s->lock);
+  if (s->stats.present)
+    s->stats.lifetime.stack_size = amount;
 }
 
 PlayerProfile RiskProfiler::get_player_profile(int player_id) const {
-  if (player_profiles.count(player_id)) {
-    return player_profiles.at(player_id);
+  const Seat *s = seat(player_id);
+  if (!s)
+    return PlayerProfile();
+  std::lock_guard<SpinLock> guard(s->lock);
+  return s->stats.present ? s->stats.lifetime : PlayerProfile();
+}
+
+ProfileStats RiskProfiler::get_stats(int player_id, StatWindow window) const {
+  ProfileStats out;
+  const Seat *s = seat(player_id);
+  if (!s)
+    return out;
+  std::lock_guard<SpinLock> guard(s->lock);
+  const SeatStats &st = s->stats;
+  if (!st.present)
+    return out;
+
+  if (window == StatWindow::LIFETIME) {
+    const PlayerProfile &p = st.lifetime;
+    out.hands = p.hands_played;
+    out.vpip = ratio(p.hands_voluntarily_entered, p.hands_played);
+    out.pfr = ratio(p.hands_raised_preflop, p.hands_played);
+    out.three_bet = ratio(p.three_bets, p.three_bet_chances);
+    out.af = aggression(p.total_bets, p.total_calls);
+  } else if (window == StatWindow::DECAYED) {
+    out.hands = st.ema_hands;
+    out.vpip = ratio(st.ema_vpip, st.ema_hands);
+    out.pfr = ratio(st.ema_pfr, st.ema_hands);
+    out.three_bet = ratio(st.ema_three_bets, st.ema_chances);
+    out.af = aggression(st.ema_bets, st.ema_calls);
+  } else {
+    int chances = std::popcount(st.recent_flags[2]);
+    out.hands = st.recent_hands;
+    out.vpip = ratio(std::popcount(st.recent_flags[0]), st.recent_hands);
+    out.pfr = ratio(std::popcount(st.recent_flags[1]), st.recent_hands);
+    out.three_bet = ratio(std::popcount(st.recent_flags[3]), chances);
+    out.af = aggression(st.recent_bet_sum, st.recent_call_sum);
   }
-  return PlayerProfile();
+  return out;
+}
+
+void RiskProfiler::close_hand(SeatStats &s) {
+  // Decayed: every count loses DECAY of its weight per hand
+  const double keep = 1.0 - DECAY;
+  s.ema_hands = s.ema_hands * keep + 1;
+  s.ema_vpip = s.ema_vpip * keep + ((s.hand_flags & VPIP) != 0);
+  s.ema_pfr = s.ema_pfr * keep + ((s.hand_flags & PFR) != 0);
+  s.ema_chances =
+      s.ema_chances * keep + ((s.hand_flags & THREE_BET_CHANCE) != 0);
+  s.ema_three_bets =
+      s.ema_three_bets * keep + ((s.hand_flags & THREE_BET) != 0);
+  s.ema_bets = s.ema_bets * keep + s.hand_bets;
+  s.ema_calls = s.ema_calls * keep + s.hand_calls;
+
+  // Recent: overwrite the oldest slot of the ring
+  uint64_t bit = 1ULL << s.recent_pos;
+  for (int f = 0; f < 4; ++f) {
+    if (s.hand_flags & (1 << f))
+      s.recent_flags[f] |= bit;
+    else
+      s.recent_flags[f] &= ~bit;
+  }
+  s.recent_bet_sum += s.hand_bets - s.recent_bets[s.recent_pos];
+  s.recent_call_sum += s.hand_calls - s.recent_calls[s.recent_pos];
+  s.recent_bets[s.recent_pos] = s.hand_bets;
+  s.recent_calls[s.recent_pos] = s.hand_calls;
+  s.recent_pos = (s.recent_pos + 1) % WINDOW_HANDS;
+  if (s.recent_hands < WINDOW_HANDS)
+    s.recent_hands++;
+
+  s.hand_flags = 0;
+  s.hand_bets = s.hand_calls = 0;
 }
 
 void RiskProfiler::reset_hand() {
-  for (auto &[id, profile] : player_profiles) {
-    profile.hands_played++;
+  for (Seat &s : seats) {
+    std::lock_guard<SpinLock> guard(s.lock);
+    SeatStats &st = s.stats;
+    if (!st.present)
+      continue;
+    if (st.in_hand)
+      close_hand(st);
+    st.in_hand = true;
+    st.lifetime.hands_played++;
   }
 }
 
 std::string RiskProfiler::get_formatted_stats(int player_id) const {
-  if (player_profiles.find(player_id) == player_profiles.end())
+  const Seat *s = seat(player_id);
+  if (!s)
     return "N/A";
-
-  const auto &p = player_profiles.at(player_id);
-
-  double vpip = 0.0;
-  double pfr = 0.0;
-  double af = 0.0;
-
-  if (p.hands_played > 0) {
-    vpip = (double)p.hands_voluntarily_entered / p.hands_played * 100.0;
-    pfr = (double)p.hands_raised_preflop / p.hands_played * 100.0;
-  }
-
-  if (p.total_calls > 0) {
-    af = (double)p.total_bets / p.total_calls;
-  } else if (p.total_bets > 0) {
-    af = 10.0; // Cap at 10
+  {
+    std::lock_guard<SpinLock> guard(s->lock);
+    if (!s->stats.present)
+      return "N/A";
   }
 
+  ProfileStats stats = get_stats(player_id);
   std::stringstream ss;
   ss << std::fixed << std::setprecision(1);
-  ss << "VPIP: " << vpip << "% | PFR: " << pfr << "% | AF: " << af;
+  ss << "VPIP: " << stats.vpip * 100.0 << "% | PFR: " << stats.pfr * 100.0
+     << "% | 3B: " << stats.three_bet * 100.0 << "% | AF: " << stats.af;
   return ss.str();
 }
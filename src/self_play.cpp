@@ -0,0 +1,234 @@
+#include "../include/self_play.h"
+#include "../include/deck.h"
+#include "../include/game_state.h"
+#include "../include/mccfr/payoff.h"
+#include "../include/mccfr/trainer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+// A hand that runs longer than this is scratched
+const int MAX_HAND_ACTIONS = 200;
+
+uint64_t mix_seed(uint64_t seed, uint64_t deal) {
+  uint64_t z = seed + 0x9E3779B97F4A7C15ull * (deal + 1);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Running sums for a mean and its 95% confidence interval
+struct Moments {
+  double n = 0, sum = 0, sum_sq = 0;
+
+  void add(double x) {
+    n++;
+    sum += x;
+    sum_sq += x * x;
+  }
+  void merge(const Moments &o) {
+    n += o.n;
+    sum += o.sum;
+    sum_sq += o.sum_sq;
+  }
+  double mean() const { return n > 0 ? sum / n : 0; }
+  double ci95() const {
+    if (n < 2)
+      return 0;
+    double var = (sum_sq - sum * sum / n) / (n - 1);
+    return 1.96 * std::sqrt(std::max(var, 0.0) / n);
+  }
+};
+
+// Per-worker totals, merged once at the end
+struct Tally {
+  std::vector<Moments> per_set;  // mbb/hand of each duplicate set
+  std::vector<Moments> per_hand; // mbb of each single hand
+  std::vector<int64_t> hands;
+  int64_t deals = 0, games = 0, scratched = 0;
+};
+
+// Plays one hand to the end with the given cards; seat i is played by
+// models[seat_model[i]]. False when the hand cannot be finished (a model
+// has no recommendation, or it runs past MAX_HAND_ACTIONS)
+bool play_hand(const std::vector<Trainer *> &models, const int *seat_model,
+               const MatchConfig &cfg, const std::vector<Card> *hole,
+               const std::vector<Card> &board, GameState &state,
+               std::vector<double> &probs, std::mt19937 &gen,
+               double *payoff) {
+  state.init_game_setup(cfg.seats, cfg.stack_bb * cfg.bb, cfg.sb, cfg.bb);
+  state.start_hand(0);
+  for (int i = 0; i < cfg.seats; ++i)
+    state.set_player_cards(i, hole[i]);
+
+  for (int steps = 0; !state.is_terminal(); ++steps) {
+    if (steps == MAX_HAND_ACTIONS)
+      return false;
+    if (state.is_betting_round_over()) {
+      // Nobody can act again: run the board out
+      if (state.stage == Stage::RIVER || Trainer::is_allin_runout(state)) {
+        state.set_community_cards(board);
+        state.stage = Stage::SHOWDOWN;
+        break;
+      }
+      size_t shown = state.stage == Stage::PREFLOP
+                         ? 3
+                         : state.community_cards.size() + 1;
+      state.set_community_cards(
+          std::vector<Card>(board.begin(), board.begin() + shown));
+      state.next_street();
+      continue;
+    }
+
+    Player *p = state.get_current_player();
+    probs.clear();
+    Action a = models[seat_model[p->id]]->get_action_recommendation(
+        state, p->id, probs, gen);
+    if (a.player_id < 0)
+      return false;
+    state.apply_action(a, false);
+  }
+  Trainer::settle(state, nullptr, payoff);
+  return true;
+}
+
+} // namespace
+
+bool run_match(const std::vector<Trainer *> &models, const MatchConfig &cfg,
+               MatchResult &result) {
+  int num_models = models.size();
+  if (num_models < 2) {
+    std::cerr << "Cannot play a match with fewer than two models\n";
+    return false;
+  }
+  if (cfg.seats < 2 || cfg.seats > MAX_SEATS ||
+      cfg.seats % num_models != 0) {
+    std::cerr << "Cannot seat " << num_models << " models at " << cfg.seats
+              << " seats (need a multiple of the model count, at most "
+              << MAX_SEATS << ")\n";
+    return false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int workers = std::max(1, cfg.workers);
+  std::vector<Tally> tallies(workers);
+  std::atomic<int64_t> next_deal{0};
+  std::atomic<int64_t> done{0};
+  std::mutex progress_mutex;
+  int64_t progress_step = std::max<int64_t>(1, cfg.deals / 10);
+
+  // Every model plays seats / num_models seats in each of `seats` rotations
+  const int seats_per_model = cfg.seats / num_models;
+  const int seat_hands = cfg.seats * seats_per_model;
+  const double mbb = 1000.0 / cfg.bb;
+
+  auto worker = [&](Tally &tally) {
+    tally.per_set.resize(num_models);
+    tally.per_hand.resize(num_models);
+    tally.hands.assign(num_models, 0);
+
+    EquityModule em;
+    GameState state(nullptr, &em);
+    std::vector<double> probs;
+    std::vector<Card> hole[MAX_SEATS], board;
+    double payoff[MAX_SEATS], set_total[MAX_SEATS];
+    // Per-hand results of the set, counted once every rotation finished
+    double hand_mbb[MAX_SEATS][MAX_SEATS];
+    int seat_model[MAX_SEATS];
+
+    while (!(cfg.stop && *cfg.stop)) {
+      int64_t deal = next_deal.fetch_add(1);
+      if (deal >= cfg.deals)
+        break;
+      uint64_t deal_seed = mix_seed(cfg.seed, deal);
+
+      FastRng rng(deal_seed);
+      Deck deck;
+      for (int i = 0; i < cfg.seats; ++i) {
+        hole[i].clear();
+        deck.draw(rng, 2, hole[i]);
+      }
+      board.clear();
+      deck.draw(rng, 5, board);
+
+      std::fill(set_total, set_total + num_models, 0.0);
+      bool finished = true;
+      for (int r = 0; r < cfg.seats && finished; ++r) {
+        // Models sit in blocks of adjacent seats, so every rotation is a
+        // distinct seating and every model holds every seat once
+        for (int i = 0; i < cfg.seats; ++i)
+          seat_model[i] = (i + r) % cfg.seats / seats_per_model;
+        // Same action seed in every rotation, so the models' sampled
+        // choices stay as correlated as their strategies allow
+        std::mt19937 gen((uint32_t)deal_seed);
+        finished = play_hand(models, seat_model, cfg, hole, board, state,
+                             probs, gen, payoff);
+        for (int i = 0; i < cfg.seats; ++i) {
+          set_total[seat_model[i]] += payoff[i];
+          hand_mbb[r][i] = payoff[i] * mbb;
+        }
+      }
+
+      // One unfinished hand scratches the whole set, which would otherwise
+      // no longer give every model every seat
+      if (finished) {
+        for (int r = 0; r < cfg.seats; ++r)
+          for (int i = 0; i < cfg.seats; ++i) {
+            int m = (i + r) % cfg.seats / seats_per_model;
+            tally.per_hand[m].add(hand_mbb[r][i]);
+            tally.hands[m]++;
+          }
+        for (int m = 0; m < num_models; ++m)
+          tally.per_set[m].add(set_total[m] / seat_hands * mbb);
+        tally.deals++;
+        tally.games += cfg.seats;
+      } else {
+        tally.scratched++;
+      }
+
+      int64_t completed = done.fetch_add(1) + 1;
+      if (completed % progress_step == 0) {
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        std::cerr << "  " << completed << "/" << cfg.deals << " deals\n";
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 1; w < workers; ++w)
+    pool.emplace_back(worker, std::ref(tallies[w]));
+  worker(tallies[0]);
+  for (auto &t : pool)
+    t.join();
+
+  std::vector<Moments> per_set(num_models), per_hand(num_models);
+  result = MatchResult();
+  result.models.resize(num_models);
+  for (const Tally &t : tallies) {
+    result.deals += t.deals;
+    result.hands += t.games;
+    result.scratched += t.scratched;
+    for (int m = 0; m < num_models; ++m) {
+      per_set[m].merge(t.per_set[m]);
+      per_hand[m].merge(t.per_hand[m]);
+      result.models[m].hands += t.hands[m];
+    }
+  }
+  for (int m = 0; m < num_models; ++m) {
+    result.models[m].mbb_per_hand = per_set[m].mean();
+    result.models[m].ci95 = per_set[m].ci95();
+    result.models[m].naive_ci95 = per_hand[m].ci95();
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return true;
+}